@@ -0,0 +1,206 @@
+#include "Batch.hpp"
+#include "Evaluator.hpp"
+#include "Heuristic.hpp"
+#include "Matrix.hpp"
+#include "SolverConfiguration.hpp"
+#include "SolverSelection.hpp"
+#include "SparseMatrix.hpp"
+#include "read_file.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    /// @brief An instance with everything the summary needs besides the solve
+    struct LoadedInstance
+    {
+        std::string path;
+        std::string name;
+        Matrix matrix;
+        double density;
+        bool has_reference;
+        std::vector<bool> reference;
+        double reference_best;
+    };
+
+    /// @brief Parse an instance and its reference solution
+    /// @param path Instance file
+    /// @param reference_directory Directory of {instance}_answer.qs files, may be empty
+    LoadedInstance load_instance(std::string const &path, std::string const &reference_directory)
+    {
+        LoadedInstance instance;
+        instance.path = path;
+        instance.name = fs::path(path).filename().string();
+        instance.matrix = read_file_test(path);
+        instance.density = read_file_nonzero(path);
+        std::string reference_path = reference_directory.empty() ? "" : (fs::path(reference_directory) / (fs::path(path).stem().string() + "_answer.qs")).string();
+        instance.has_reference = !reference_path.empty() && fs::is_regular_file(reference_path);
+        if (instance.has_reference)
+        {
+            instance.reference = read_answer_test(reference_path, instance.matrix.size());
+            instance.reference_best = read_answer_best(reference_path);
+            // a reference that does not fit the instance was reported and is left out
+            instance.has_reference = !instance.reference.empty();
+        }
+        return instance;
+    }
+}
+
+AsyncWriter::AsyncWriter()
+    : _files(),
+      _closing{false},
+      _thread([this]()
+              { this->_run(); }) {}
+AsyncWriter::~AsyncWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closing = true;
+    }
+    _ready.notify_one();
+    _thread.join();
+}
+auto AsyncWriter::write(std::string path, std::string content) -> void
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _files.emplace_back(std::move(path), std::move(content));
+    }
+    _ready.notify_one();
+}
+auto AsyncWriter::_run() -> void
+{
+    while (true)
+    {
+        std::pair<std::string, std::string> file;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(lock, [this]()
+                        { return _closing || !_files.empty(); });
+            if (_files.empty())
+            {
+                return;
+            }
+            file = std::move(_files.front());
+            _files.pop_front();
+        }
+        std::ofstream stream(file.first);
+        stream << file.second;
+        if (!stream)
+        {
+            std::cerr << "Could not write " << file.first << std::endl;
+        }
+    }
+}
+
+auto run_batch(BatchOptions const &options) -> bool
+{
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (fs::recursive_directory_iterator entry(options.instance_directory, error), end; !error && entry != end; entry.increment(error))
+    {
+        if (entry->is_regular_file() && entry->path().extension() == ".qs")
+        {
+            paths.push_back(entry->path().string());
+        }
+    }
+    if (paths.empty())
+    {
+        std::cout << "No .qs instances found in " << options.instance_directory << std::endl;
+        return false;
+    }
+    std::sort(paths.begin(), paths.end());
+    for (auto const &directory : {options.solution_directory, options.log_directory})
+    {
+        if (!directory.empty())
+        {
+            fs::create_directories(directory, error);
+        }
+    }
+    auto rules = options.rules_path.empty() ? default_selection_rules() : read_selection_rules(options.rules_path);
+    std::map<std::string, SolverConfiguration> configurations;
+    if (!options.configuration_path.empty())
+    {
+        configurations = read_configurations(options.configuration_path);
+    }
+
+    AsyncWriter writer;
+    std::future<LoadedInstance> next = std::async(std::launch::async, load_instance, paths[0], options.reference_directory);
+    for (unsigned index = 0; index < paths.size(); index++)
+    {
+        LoadedInstance instance = next.get();
+        // parse the following instance while this one is solved
+        if (index + 1 < paths.size())
+        {
+            next = std::async(std::launch::async, load_instance, paths[index + 1], options.reference_directory);
+        }
+        if (instance.matrix.size() == 0)
+        {
+            std::cout << instance.name << " is not a QPLIB instance" << std::endl;
+            continue;
+        }
+
+        auto start_time = std::chrono::steady_clock::now();
+        SolverConfiguration configuration = configure_solver(options.solver, instance.matrix, rules, configurations, options.parameters);
+        std::unique_ptr<Heuristic> heuristic(create_heuristic(configuration, instance.matrix, options.has_seed ? options.seed : std::random_device()()));
+        if (heuristic == nullptr)
+        {
+            std::cout << "Unknown solver " << configuration.solver << std::endl;
+            return false;
+        }
+        heuristic->solve(options.seconds);
+        std::vector<bool> result = heuristic->get_solution();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+        std::vector<std::vector<bool>> solutions{result};
+        if (instance.has_reference)
+        {
+            solutions.push_back(instance.reference);
+        }
+        std::vector<double> values = evaluate_batch(SparseMatrix(instance.matrix), solutions);
+        std::string stem = fs::path(instance.path).stem().string();
+        if (!options.solution_directory.empty())
+        {
+            std::ostringstream solution;
+            write_answer(solution, values[0], result);
+            writer.write((fs::path(options.solution_directory) / (stem + ".sol")).string(), solution.str());
+        }
+        if (!options.log_directory.empty())
+        {
+            writer.write((fs::path(options.log_directory) / (stem + ".log")).string(), heuristic->get_output());
+        }
+
+        std::cout << configuration.solver << " " << instance.name << " "
+                  << instance.matrix.size() << " "
+                  << instance.density << " "
+                  << std::setprecision(0) << std::fixed << values[0] << " "
+                  << std::setprecision(2) << std::fixed << seconds << "s ";
+        if (instance.has_reference)
+        {
+            std::cout << std::setprecision(0) << std::fixed << values.back() << " " << instance.reference_best << std::endl;
+        }
+        else
+        {
+            std::cout << "- -" << std::endl;
+        }
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+    return true;
+}
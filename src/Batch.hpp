@@ -0,0 +1,70 @@
+/**
+ * @file Batch.hpp
+ * @author Gennesaret Tjusila
+ * @brief Solving a directory of instances with loading and writing overlapped with solving
+ */
+#ifndef Batch_H
+#define Batch_H
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// @brief Settings of a batch run
+struct BatchOptions
+{
+    /// @brief Directory searched recursively for .qs instances
+    std::string instance_directory;
+    /// @brief Directory of {instance}_answer.qs reference solutions, optional
+    std::string reference_directory;
+    /// @brief Directory the solutions are written to, optional
+    std::string solution_directory;
+    /// @brief Directory the iteration logs are written to, optional
+    std::string log_directory;
+    std::string solver = "DTSS";
+    /// @brief Seconds per instance
+    unsigned seconds = 600;
+    bool has_seed = false;
+    unsigned seed = 0;
+    /// @brief Tuned parameters per instance class, optional
+    std::string configuration_path;
+    /// @brief Solver selection rules of AUTO, the built-in ones if empty
+    std::string rules_path;
+    /// @brief Solver parameters given by name
+    std::vector<std::pair<std::string, std::string>> parameters;
+};
+
+/// @brief Writes files on a background thread in the order they were queued
+class AsyncWriter
+{
+public:
+    AsyncWriter();
+    /// @brief Write all queued files, then stop the thread
+    ~AsyncWriter();
+    AsyncWriter(AsyncWriter const &) = delete;
+    AsyncWriter &operator=(AsyncWriter const &) = delete;
+    /// @brief Queue a file
+    /// @param path File path, an existing file is replaced
+    /// @param content File content
+    void write(std::string path, std::string content);
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::deque<std::pair<std::string, std::string>> _files;
+    bool _closing;
+    std::thread _thread;
+    void _run();
+};
+
+/// @brief Solve every instance of a directory, one summary line per instance
+///
+/// The next instance is parsed on a background thread while the current one is solved,
+/// so at most two instances are in memory. Solutions and logs are written by an AsyncWriter.
+/// @param options Batch settings
+/// @return False if no instance was found or the solver is unknown
+bool run_batch(BatchOptions const &options);
+#endif
@@ -0,0 +1,157 @@
+#include "Checkpoint.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // the last character is the format version, raise it whenever a solver payload changes layout.
+    // 2: DTSS and MSTS store their tabu policy state
+    char const checkpoint_magic[8] = {'G', 'U', 'M', 'M', 'Y', 'C', 'K', '2'};
+    volatile std::sig_atomic_t checkpoint_signal = 0;
+    volatile std::sig_atomic_t stop_signal = 0;
+
+    void handle_checkpoint_signal(int signal)
+    {
+        checkpoint_signal = 1;
+        if (signal == SIGTERM)
+        {
+            stop_signal = 1;
+        }
+    }
+}
+
+auto write_solution(std::ostream &stream, std::vector<bool> const &solution) -> void
+{
+    std::vector<unsigned char> packed((solution.size() + 7) / 8, 0);
+    for (unsigned i = 0; i < solution.size(); i++)
+    {
+        if (solution[i])
+        {
+            packed[i / 8] |= 1 << (i % 8);
+        }
+    }
+    write_value<unsigned>(stream, solution.size());
+    stream.write(reinterpret_cast<char const *>(packed.data()), packed.size());
+}
+auto read_solution(std::istream &stream, unsigned size) -> std::vector<bool>
+{
+    unsigned stored_size = read_value<unsigned>(stream);
+    std::vector<unsigned char> packed((stored_size + 7) / 8, 0);
+    stream.read(reinterpret_cast<char *>(packed.data()), packed.size());
+    if (stored_size != size)
+    {
+        stream.setstate(std::ios::failbit);
+        return std::vector<bool>(size, false);
+    }
+    std::vector<bool> solution(size, false);
+    for (unsigned i = 0; i < size; i++)
+    {
+        solution[i] = (packed[i / 8] >> (i % 8)) & 1;
+    }
+    return solution;
+}
+auto write_doubles(std::ostream &stream, std::vector<double> const &values) -> void
+{
+    write_value<unsigned>(stream, values.size());
+    stream.write(reinterpret_cast<char const *>(values.data()), values.size() * sizeof(double));
+}
+auto read_doubles(std::istream &stream) -> std::vector<double>
+{
+    std::vector<double> values(read_value<unsigned>(stream));
+    stream.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(double));
+    return values;
+}
+auto write_random_engine(std::ostream &stream, std::mt19937 const &random_engine) -> void
+{
+    // the standard only defines the textual engine state, store its words in binary
+    std::stringstream state;
+    state << random_engine;
+    std::vector<std::uint32_t> words;
+    std::uint32_t word;
+    while (state >> word)
+    {
+        words.push_back(word);
+    }
+    write_value<unsigned>(stream, words.size());
+    stream.write(reinterpret_cast<char const *>(words.data()), words.size() * sizeof(std::uint32_t));
+}
+auto read_random_engine(std::istream &stream, std::mt19937 &random_engine) -> void
+{
+    std::vector<std::uint32_t> words(read_value<unsigned>(stream) % (std::mt19937::state_size + 2));
+    stream.read(reinterpret_cast<char *>(words.data()), words.size() * sizeof(std::uint32_t));
+    std::stringstream state;
+    for (std::uint32_t word : words)
+    {
+        state << word << ' ';
+    }
+    state >> random_engine;
+}
+auto write_header(std::ostream &stream, std::string const &solver, unsigned size) -> void
+{
+    stream.write(checkpoint_magic, sizeof(checkpoint_magic));
+    write_value<unsigned>(stream, solver.size());
+    stream.write(solver.data(), solver.size());
+    write_value<unsigned>(stream, size);
+}
+auto read_header(std::istream &stream, std::string const &solver, unsigned size) -> bool
+{
+    char magic[sizeof(checkpoint_magic)] = {};
+    stream.read(magic, sizeof(magic));
+    if (!stream || !std::equal(magic, magic + sizeof(magic), checkpoint_magic))
+    {
+        return false;
+    }
+    unsigned name_length = read_value<unsigned>(stream);
+    if (!stream || name_length > 64)
+    {
+        return false;
+    }
+    std::string stored_solver(name_length, ' ');
+    stream.read(&stored_solver[0], stored_solver.size());
+    unsigned stored_size = read_value<unsigned>(stream);
+    return stream && stored_solver == solver && stored_size == size;
+}
+
+auto install_checkpoint_signal_handlers() -> void
+{
+    std::signal(SIGUSR1, handle_checkpoint_signal);
+    std::signal(SIGTERM, handle_checkpoint_signal);
+}
+
+CheckpointSchedule::CheckpointSchedule()
+    : _path(),
+      _interval{0},
+      _last_write(std::chrono::steady_clock::now()) {}
+auto CheckpointSchedule::enable(std::string path, unsigned interval) -> void
+{
+    _path = path;
+    _interval = interval;
+    _last_write = std::chrono::steady_clock::now();
+}
+auto CheckpointSchedule::due() -> bool
+{
+    if (!this->enabled())
+    {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    bool timer_due = _interval > 0 && now - _last_write >= std::chrono::seconds(_interval);
+    if (timer_due || checkpoint_signal)
+    {
+        checkpoint_signal = 0;
+        _last_write = now;
+        return true;
+    }
+    return false;
+}
+auto CheckpointSchedule::stop_requested() const -> bool
+{
+    return stop_signal;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file Checkpoint.hpp
+ * @author Gennesaret Tjusila
+ * @brief Binary checkpoint format and checkpoint scheduling for heuristic solvers
+ */
+#ifndef Checkpoint_H
+#define Checkpoint_H
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/// @brief Write a trivially copyable value
+template <typename T>
+void write_value(std::ostream &stream, T const &value)
+{
+    stream.write(reinterpret_cast<char const *>(&value), sizeof(T));
+}
+/// @brief Read a trivially copyable value
+template <typename T>
+T read_value(std::istream &stream)
+{
+    T value{};
+    stream.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return value;
+}
+/// @brief Write a solution vector packed 8 variables per byte
+void write_solution(std::ostream &stream, std::vector<bool> const &solution);
+/// @brief Read a packed solution vector
+/// @param size Expected problem size
+std::vector<bool> read_solution(std::istream &stream, unsigned size);
+/// @brief Write a vector of doubles
+void write_doubles(std::ostream &stream, std::vector<double> const &values);
+/// @brief Read a vector of doubles
+std::vector<double> read_doubles(std::istream &stream);
+/// @brief Write the full state of a random engine
+void write_random_engine(std::ostream &stream, std::mt19937 const &random_engine);
+/// @brief Restore the full state of a random engine
+void read_random_engine(std::istream &stream, std::mt19937 &random_engine);
+/// @brief Write the checkpoint header
+/// @param solver Solver name
+/// @param size Problem size
+void write_header(std::ostream &stream, std::string const &solver, unsigned size);
+/// @brief Check the checkpoint header
+/// @param solver Expected solver name
+/// @param size Expected problem size
+/// @return True if the checkpoint belongs to this solver and problem size
+bool read_header(std::istream &stream, std::string const &solver, unsigned size);
+
+/// @brief Install SIGUSR1 (checkpoint and continue) and SIGTERM (checkpoint and stop) handlers
+void install_checkpoint_signal_handlers();
+
+/// @brief Decides when a solver writes its checkpoint
+class CheckpointSchedule
+{
+public:
+    CheckpointSchedule();
+    /// @brief Enable checkpointing
+    /// @param path Checkpoint file path
+    /// @param interval Seconds between timed checkpoints, 0 writes only on signals
+    void enable(std::string path, unsigned interval);
+    bool enabled() const
+    {
+        return !_path.empty();
+    }
+    std::string const &path() const
+    {
+        return _path;
+    }
+    /// @brief Check if the interval elapsed or a checkpoint signal was caught, resets both
+    bool due();
+    /// @brief Check if a stop signal was caught
+    bool stop_requested() const;
+
+private:
+    std::string _path;
+    unsigned _interval;
+    std::chrono::steady_clock::time_point _last_write;
+};
+#endif
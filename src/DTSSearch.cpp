@@ -1,17 +1,20 @@
 #include "DTSSearch.hpp"
+#include "Checkpoint.hpp"
+#include "Instrumentation.hpp"
 #include "Matrix.hpp"
+#include "PairMoves.hpp"
+#include "SparseMatrix.hpp"
+#include "WeightedSampler.hpp"
 #include <algorithm>
 #include <chrono>
 #include <climits>
+#include <cmath>
 #include <iostream>
+#include <numeric>
 #include <queue>
 #include <random>
 #include <utility>
 #include <vector>
-using elite_solution_container = std::priority_queue<
-    std::pair<double, std::vector<bool>>,
-    std::vector<std::pair<double, std::vector<bool>>>,
-    std::greater<>>;
 DTSSearch::DTSSearch(Matrix const &matrix, unsigned size)
     : DTSSearch(matrix, size, std::random_device()()) {}
 DTSSearch::DTSSearch(Matrix const &matrix, unsigned size, unsigned seed)
@@ -20,7 +23,31 @@ DTSSearch::DTSSearch(Matrix const &matrix, unsigned size, unsigned seed)
       output(),
       _solved{false},
       _last_solution(size, false),
-      _random_engine(seed) {}
+      _random_engine(seed),
+      _rank_weight(size),
+      _flip_count(size, 0),
+      _flipped(),
+      _max_flip{1},
+      _current_solution(size, false),
+      _elite_solution(),
+      _elite_frequency(size, 0),
+      _best_found_value{INT_MIN},
+      _iter_count{0},
+      _last_update{0},
+      _parameters(),
+      _tabu(size),
+      _sparse()
+{
+    for (unsigned i = 0; i < _size; i++)
+    {
+        _rank_weight[i] = pow(i + 1, -1.2);
+    }
+}
+auto DTSSearch::set_parameters(DTSSParameters const &parameters) -> void
+{
+    _parameters = parameters;
+    _tabu = TabuPolicy(_size, parameters.tabu);
+}
 auto DTSSearch::_initialize(std::vector<bool> &current_solution) -> void
 {
     std::uniform_real_distribution<> dis(0, 1.0);
@@ -32,6 +59,100 @@ auto DTSSearch::_initialize(std::vector<bool> &current_solution) -> void
         }
     }
 }
+auto DTSSearch::_insert_elite(std::vector<bool> const &solution, double value, std::vector<unsigned> &changed) -> bool
+{
+    // fill up the Elite Solution list
+    if (_elite_solution.size() < _parameters.elite_size)
+    {
+        for (unsigned i = 0; i < _size; i++)
+        {
+            if (solution[i] == 1)
+            {
+                _elite_frequency[i]++;
+            }
+        }
+        _elite_solution.emplace(value, solution);
+        return true;
+    }
+    // substitute the worse elite solution
+    if (value > _elite_solution.top().first)
+    {
+        std::vector<bool> to_go = _elite_solution.top().second;
+        _elite_solution.pop();
+        _elite_solution.emplace(value, solution);
+        for (unsigned i = 0; i < _size; i++)
+        {
+            if (solution[i] != to_go[i])
+            {
+                _elite_frequency[i] += solution[i] ? 1 : -1;
+                changed.push_back(i);
+            }
+        }
+    }
+    return false;
+}
+auto DTSSearch::warm_start(std::vector<std::vector<bool>> const &solutions) -> void
+{
+    for (auto const &solution : solutions)
+    {
+        if (solution.size() != _size)
+        {
+            continue;
+        }
+        std::vector<double> row_value(_size, 0);
+        std::vector<double> column_value(_size, 0);
+        this->_compute_row_and_column_values(solution, row_value, column_value);
+        double value = 0;
+        for (unsigned i = 0; i < _size; i++)
+        {
+            value += (row_value[i] + _matrix(i, i)) * solution[i];
+        }
+        if (value > _best_found_value)
+        {
+            _best_found_value = value;
+            _last_solution = solution;
+        }
+        std::vector<unsigned> changed;
+        this->_insert_elite(solution, value, changed);
+    }
+    // the first search starts from the best supplied solution
+    if (!_elite_solution.empty())
+    {
+        _current_solution = _last_solution;
+        _solved = true;
+    }
+}
+auto DTSSearch::update_instance(std::vector<QuboEdit> const &changes) -> void
+{
+    // the gain vectors only live during a tabu search, so only stored objective values change
+    auto changed_value = [&changes](std::vector<bool> const &solution)
+    {
+        double value = 0;
+        for (auto const &change : changes)
+        {
+            value += change.value * solution[change.row] * solution[change.column];
+        }
+        return value;
+    };
+    _best_found_value += changed_value(_last_solution);
+    if (_sparse.size() == _size)
+    {
+        for (auto const &change : changes)
+        {
+            _sparse.add(change.row, change.column, change.value);
+        }
+    }
+    elite_solution_container elite_solution;
+    while (!_elite_solution.empty())
+    {
+        auto const &elite = _elite_solution.top();
+        elite_solution.emplace(elite.first + changed_value(elite.second), elite.second);
+        _elite_solution.pop();
+    }
+    _elite_solution.swap(elite_solution);
+    // the changed landscape restarts the stagnation count
+    _last_update = _iter_count;
+}
 auto DTSSearch::solve(unsigned time_limit) -> void
 {
     this->_outer_search_loop(time_limit);
@@ -48,17 +169,14 @@ auto DTSSearch::_compute_row_and_column_values(const std::vector<bool> &solution
     }
 }
 // tabu search
-auto DTSSearch::_inner_search_loop(std::vector<bool> &final_solution, std::vector<double> &flip_count) -> double
+auto DTSSearch::_inner_search_loop(std::vector<bool> &final_solution) -> double
 {
-    unsigned c = std::min(unsigned(20), _size / 4);
-    unsigned a = 10000;                                                     // Improvement Cutoff
-    std::uniform_int_distribution<std::mt19937::result_type> dist10(1, 10); // distribution in range [1, 10]
     std::vector<double> column_value(_size, 0);
     std::vector<bool> current_solution(final_solution);
     std::vector<bool> best_solution(_size, false);
     std::vector<double> row_value(_size, 0);
     this->_compute_row_and_column_values(current_solution, row_value, column_value);
-    unsigned best_index = -1;
+    unsigned best_index = _size;
     double best_update = 0;
     double delta_i = 0;
     unsigned iteration_count = 0;
@@ -68,62 +186,113 @@ auto DTSSearch::_inner_search_loop(std::vector<bool> &final_solution, std::vecto
     {
         current_value += (row_value[i] + _matrix(i, i)) * current_solution[i];
     }
-    unsigned last_update = 0;
     unsigned local_search = false;
     std::vector<double> tabu_tenure(_size, 0);
-    while (iteration_count <= last_update + a)
+    // single flip gains of the last full scan, the pair moves reuse them
+    std::vector<double> gain(_size, 0);
+    bool pair_moves = _tabu.parameters().pair_moves;
+    if (pair_moves && _sparse.size() != _size)
     {
-        best_index = 0;
+        _sparse = SparseMatrix(_matrix);
+    }
+    _tabu.begin();
+    while (_tabu.proceed(iteration_count))
+    {
+        // best_index stays _size if every variable is tabu, the iteration then only lets tenures run out
+        best_index = _size;
         best_update = INT_MIN;
-        for (unsigned i = 0; i < _size; i++)
+        bool scan_complete = true;
         {
-            delta_i = (1 - 2 * current_solution[i]) * (row_value[i] + column_value[i] + _matrix(i, i));
-            // if not tabu and higher delta
-            if ((delta_i > best_update && (local_search || tabu_tenure[i] <= iteration_count)))
-            {
-                best_index = i;
-                best_update = delta_i;
-            }
-            // found best solution
-            if (current_value + delta_i > best_value)
+            GUMMY_PHASE(_statistics, Phase::scan);
+            for (unsigned i = 0; i < _size; i++)
             {
-                // do local search
-                local_search = true;
-                best_index = i;
-                best_update = delta_i;
-                break;
+                GUMMY_COUNT(_statistics, moves_evaluated, 1);
+                delta_i = (1 - 2 * current_solution[i]) * (row_value[i] + column_value[i] + _matrix(i, i));
+                gain[i] = delta_i;
+                GUMMY_COUNT(_statistics, tabu_rejections, delta_i > best_update && !local_search && tabu_tenure[i] > iteration_count);
+                // if not tabu and higher delta
+                if ((delta_i > best_update && (local_search || tabu_tenure[i] <= iteration_count)))
+                {
+                    best_index = i;
+                    best_update = delta_i;
+                }
+                // found best solution
+                if (current_value + delta_i > best_value)
+                {
+                    GUMMY_COUNT(_statistics, aspiration_hits, 1);
+                    // do local search
+                    local_search = true;
+                    best_index = i;
+                    best_update = delta_i;
+                    scan_complete = false;
+                    break;
+                }
             }
         }
         if (best_update <= 0)
         {
             local_search = false;
         }
-        // update value
-        for (unsigned i = 0; i < _size; i++)
+        // no single flip improves, a pair of interacting bits may still leave the plateau
+        unsigned pair_index = _size;
+        if (best_update <= 0 && pair_moves && scan_complete)
         {
-            if (i < best_index)
+            GUMMY_PHASE(_statistics, Phase::scan);
+            PairMove pair = best_pair_move(_sparse, current_solution, gain, tabu_tenure, iteration_count, best_value - current_value);
+            if (pair.first != pair.second && pair.gain > best_update)
             {
-                column_value[i] += (1 - 2 * current_solution[best_index]) * _matrix(best_index, i);
+                GUMMY_COUNT(_statistics, pair_moves, 1);
+                best_index = pair.first;
+                pair_index = pair.second;
+                best_update = pair.gain;
             }
-            else if (i > best_index)
+        }
+        if (best_index != _size)
+        {
+            current_value = current_value + best_update;
+        }
+        for (unsigned flipped : {best_index, pair_index})
+        {
+            if (flipped == _size)
+            {
+                continue;
+            }
+            // update value
+            {
+                GUMMY_PHASE(_statistics, Phase::update);
+                for (unsigned i = 0; i < _size; i++)
+                {
+                    if (i < flipped)
+                    {
+                        column_value[i] += (1 - 2 * current_solution[flipped]) * _matrix(flipped, i);
+                    }
+                    else if (i > flipped)
+                    {
+                        row_value[i] += (1 - 2 * current_solution[flipped]) * _matrix(i, flipped);
+                    }
+                }
+            }
+            GUMMY_COUNT(_statistics, flips_applied, 1);
+            // flip bit
+            current_solution[flipped] = !current_solution[flipped];
+            // bit become tabu
+            _tabu.flip(flipped, iteration_count);
+            tabu_tenure[flipped] = iteration_count + _tabu.tenure(_random_engine);
+            if (_flip_count[flipped]++ == 0)
             {
-                row_value[i] += (1 - 2 * current_solution[best_index]) * _matrix(i, best_index);
+                _flipped.push_back(flipped);
             }
+            _max_flip = std::max(_max_flip, _flip_count[flipped]);
         }
-        // flip bit
-        current_solution[best_index] = !current_solution[best_index];
-        current_value = current_value + best_update;
         if (current_value > best_value)
         {
             best_value = current_value;
-            last_update = iteration_count;
+            _tabu.improved(iteration_count);
             std::copy(current_solution.begin(), current_solution.end(), best_solution.begin());
         }
-        // bit become tabu
-        tabu_tenure[best_index] = iteration_count + c + dist10(_random_engine);
         iteration_count++;
-        flip_count[best_index]++;
     };
+    _tabu.end();
     std::copy(best_solution.begin(), best_solution.end(), final_solution.begin());
     return best_value;
 }
@@ -136,115 +305,202 @@ auto DTSSearch::_outer_search_loop(unsigned time_limit) -> void
     std::chrono::duration<double, std::milli> duration_inside;        // Stop time
 
     start_time_ms = std::chrono::high_resolution_clock::now();
-    std::vector<bool> current_solution(_size, false);
-    std::vector<bool> best_found_solution(_size, false);
-    this->_initialize(current_solution);
-    elite_solution_container elite_solution;
-    std::vector<double> elite_frequency(_size, 0);
-    double best_found_value = INT_MIN;
-    unsigned iter_count = 0;
-    unsigned last_update = 0;
+    // a restored checkpoint continues where it stopped
+    if (!_solved)
+    {
+        this->_initialize(_current_solution);
+        _solved = true;
+    }
+    // score = elite term + 0.3 * (1 - flip_count / max_flip), a variable that was not flipped keeps its base score
+    std::vector<double> base_score(_size, 0.3);
+    std::vector<double> score(_size, 0.3);
+    auto by_score = [&score](unsigned i1, unsigned i2)
+    { return score[i1] < score[i2]; };
+    // ranking of the variables by score and the rank of every variable, repaired for the changed scores only
+    std::vector<unsigned> idx(_size);
+    std::iota(idx.begin(), idx.end(), 0);
+    std::vector<unsigned> position(idx);
+    // move a variable whose score changed to its place, all other variables are in order. Costs the distance moved
+    auto reposition = [&](unsigned i)
+    {
+        auto slot = idx.begin() + position[i];
+        auto first = slot;
+        auto last = slot + 1;
+        if (slot != idx.begin() && by_score(i, *(slot - 1)))
+        {
+            first = std::upper_bound(idx.begin(), slot, i, by_score);
+            std::rotate(first, slot, slot + 1);
+        }
+        else if (slot + 1 != idx.end() && by_score(*(slot + 1), i))
+        {
+            last = std::lower_bound(slot + 1, idx.end(), i, by_score);
+            std::rotate(slot, slot + 1, last);
+        }
+        for (auto entry = first; entry != last; ++entry)
+        {
+            position[*entry] = entry - idx.begin();
+        }
+    };
+    // one sampler serves every perturbation, refilled with fresh noise on the rank weights each time
+    WeightedSampler sampler(_rank_weight);
+    std::vector<double> noisy_weight(_size);
+    std::uniform_real_distribution<double> noise(0.0, 0.05);
+    std::vector<unsigned> changed;
+    std::vector<bool> is_changed(_size, false);
+    auto mark_changed = [&](unsigned i)
+    {
+        if (!is_changed[i])
+        {
+            is_changed[i] = true;
+            changed.push_back(i);
+        }
+    };
+    auto update_base_score = [&](unsigned i)
+    {
+        double r = _elite_solution.size();
+        base_score[i] = (_elite_frequency[i] * (r - _elite_frequency[i])) / (r * r) + 0.3;
+        mark_changed(i);
+    };
+    if (!_elite_solution.empty())
+    {
+        for (unsigned i = 0; i < _size; i++)
+        {
+            update_base_score(i);
+        }
+    }
+    unsigned run_iter_count = 0;
     // do until best solution stuck for 100 iterations
-    while (iter_count < last_update + 100)
+    while (_iter_count < _last_update + 100)
     {
         start_time_inside = std::chrono::high_resolution_clock::now();
-        std::vector<double> flip_count(_size, 0);
-        std::vector<double> score(_size, 0);
-        auto current_value = this->_inner_search_loop(current_solution, flip_count);
-        if (current_value > best_found_value)
+        auto current_value = this->_inner_search_loop(_current_solution);
+        if (current_value > _best_found_value)
         {
-            std::copy(current_solution.begin(), current_solution.end(), best_found_solution.begin());
-            best_found_value = current_value;
-            last_update = iter_count;
+            std::copy(_current_solution.begin(), _current_solution.end(), _last_solution.begin());
+            _best_found_value = current_value;
+            _last_update = _iter_count;
         }
-        int r = (int)elite_solution.size();
-        // fill up the Elite Solution list
-        if (r < 20)
         {
-            for (unsigned i = 0; i < _size; i++)
+            GUMMY_PHASE(_statistics, Phase::elite);
+            std::vector<unsigned> elite_changed;
+            bool elite_grown = this->_insert_elite(_current_solution, current_value, elite_changed);
+            // solutions of other searches join the elite pool, a better one is also perturbed next
+            for (auto const &[value, solution] : _migrants)
             {
-                if (current_solution[i] == 1)
+                if (solution.size() != _size)
                 {
-                    elite_frequency[i]++;
+                    continue;
                 }
+                if (value > _best_found_value)
+                {
+                    _last_solution = solution;
+                    _best_found_value = value;
+                    _last_update = _iter_count;
+                }
+                if (value > current_value)
+                {
+                    _current_solution = solution;
+                    current_value = value;
+                }
+                elite_grown = this->_insert_elite(solution, value, elite_changed) || elite_grown;
+            }
+            _migrants.clear();
+            if (elite_grown)
+            {
+                // the pool size changed, so every elite term changes
+                for (unsigned i = 0; i < _size; i++)
+                {
+                    update_base_score(i);
+                }
+            }
+            for (unsigned i : elite_changed)
+            {
+                update_base_score(i);
             }
-            elite_solution.emplace(current_value, std::vector<bool>(current_solution));
         }
-        // substitute the worse elite solution
-        else if (current_value > elite_solution.top().first)
         {
-            std::vector<bool> to_go = elite_solution.top().second;
-            elite_solution.pop();
-            for (unsigned i = 0; i < _size; i++)
+            GUMMY_PHASE(_statistics, Phase::perturbation);
+            // score function of the flipped variables
+            for (unsigned i : _flipped)
+            {
+                mark_changed(i);
+            }
+            // rank the scores, moving only the changed variables if there are few of them
+            if (4 * changed.size() > _size)
             {
-                if (current_solution[i])
+                for (unsigned i : changed)
                 {
-                    elite_frequency[i]++;
+                    score[i] = base_score[i] - 0.3 * _flip_count[i] / _max_flip;
                 }
-                if (to_go[i])
+                std::sort(idx.begin(), idx.end(), by_score);
+                for (unsigned rank = 0; rank < _size; rank++)
                 {
-                    elite_frequency[i]--;
+                    position[idx[rank]] = rank;
                 }
             }
-            elite_solution.emplace(current_value, std::vector<bool>(current_solution));
-        }
-        double max_flip = *std::max(flip_count.begin(), flip_count.end());
-        // score function
-        for (unsigned i = 0; i < _size; i++)
-        {
-            score[i] = (elite_frequency[i] * (r - elite_frequency[i]) * 1.0) / (r * r) + 0.3 * (1 - flip_count[i] / max_flip);
-        }
-        // sort the scores
-        std::vector<unsigned> idx(_size);
-        std::iota(idx.begin(), idx.end(), 0);
-        std::sort(idx.begin(), idx.end(),
-                  [score](size_t i1, size_t i2)
-                  { return score[i1] < score[i2]; });
-        std::vector<double> probability(_size);
-        std::uniform_real_distribution<double> distribution(0.0, 0.05);
-        // assign probability
-        for (unsigned i = 0; i < _size; i++)
-        {
-            probability[i] = pow(i + 1, -1.2) + distribution(_random_engine);
-        }
-        // pick critical variables
-        std::discrete_distribution<unsigned> gen(probability.begin(), probability.end());
-        std::vector<bool> picked(_size, false);
-        int pick_count = _size / 10;
-        int sum = 0;
-        while (pick_count > 0)
-        {
-            unsigned q = gen(_random_engine);
-            int index = idx[q];
-            if (!picked[index])
+            else
+            {
+                for (unsigned i : changed)
+                {
+                    score[i] = base_score[i] - 0.3 * _flip_count[i] / _max_flip;
+                    reposition(i);
+                }
+            }
+            for (unsigned i : changed)
             {
-                current_solution[index] = !current_solution[index];
-                pick_count--;
-                picked[index] = true;
-                sum += index;
+                is_changed[i] = false;
             }
+            changed.clear();
+            // pick critical variables
+            for (unsigned i = 0; i < _size; i++)
+            {
+                noisy_weight[i] = _rank_weight[i] + noise(_random_engine);
+            }
+            sampler.reset(noisy_weight);
+            unsigned pick_count = _parameters.pick_fraction * _size;
+            for (unsigned pick = 0; pick < pick_count && sampler.remaining() > 0; pick++)
+            {
+                unsigned index = idx[sampler.sample(_random_engine)];
+                _current_solution[index] = !_current_solution[index];
+            }
+            // the flip counts restart with the next tabu search
+            for (unsigned i : _flipped)
+            {
+                _flip_count[i] = 0;
+                mark_changed(i);
+            }
+            _flipped.clear();
+            _max_flip = 1;
         }
-        iter_count++;
+        _iter_count++;
+        run_iter_count++;
+        GUMMY_COUNT(_statistics, restarts, 1);
 
         duration_ms = (std::chrono::high_resolution_clock::now() - start_time_ms) / 1000;
         duration_inside = (std::chrono::high_resolution_clock::now() - start_time_inside) / 1000;
 
-        output += "Iteration: ";
-        output += std::to_string(iter_count);
-        output += ";Local Best: ";
-        output += std::to_string(current_value);
-        output += ";Current Best: ";
-        output += std::to_string(best_found_value);
-        output += ";time: ";
-        output += std::to_string(duration_inside.count());
-        output += "\n";
+        {
+            GUMMY_PHASE(_statistics, Phase::logging);
+            output += "Iteration: ";
+            output += std::to_string(_iter_count);
+            output += ";Local Best: ";
+            output += std::to_string(current_value);
+            output += ";Current Best: ";
+            output += std::to_string(_best_found_value);
+            output += ";time: ";
+            output += std::to_string(duration_inside.count());
+            output += "\n";
+        }
 
-        if (duration_ms.count() + duration_ms.count() / iter_count >= time_limit)
+        if (this->_end_of_iteration(_last_solution, _best_found_value))
+        {
+            break;
+        }
+        if (duration_ms.count() + duration_ms.count() / run_iter_count >= time_limit)
         {
             break;
         }
     }
-    std::copy(best_found_solution.begin(), best_found_solution.end(), _last_solution.begin());
 }
 auto DTSSearch::get_solution() -> std::vector<bool>
 {
@@ -254,3 +510,49 @@ auto DTSSearch::get_output() -> std::string
 {
     return output;
 }
+
+auto DTSSearch::save_checkpoint(std::ostream &stream) -> void
+{
+    write_header(stream, "DTSS", _size);
+    write_random_engine(stream, _random_engine);
+    write_solution(stream, _current_solution);
+    write_solution(stream, _last_solution);
+    write_value<double>(stream, _best_found_value);
+    write_value<unsigned>(stream, _iter_count);
+    write_value<unsigned>(stream, _last_update);
+    _tabu.save(stream);
+    write_doubles(stream, _elite_frequency);
+    // the priority queue can only be walked by popping a copy
+    elite_solution_container elite_solution(_elite_solution);
+    write_value<unsigned>(stream, elite_solution.size());
+    while (!elite_solution.empty())
+    {
+        write_value<double>(stream, elite_solution.top().first);
+        write_solution(stream, elite_solution.top().second);
+        elite_solution.pop();
+    }
+}
+auto DTSSearch::load_checkpoint(std::istream &stream) -> bool
+{
+    if (!read_header(stream, "DTSS", _size))
+    {
+        return false;
+    }
+    read_random_engine(stream, _random_engine);
+    _current_solution = read_solution(stream, _size);
+    _last_solution = read_solution(stream, _size);
+    _best_found_value = read_value<double>(stream);
+    _iter_count = read_value<unsigned>(stream);
+    _last_update = read_value<unsigned>(stream);
+    _tabu.load(stream);
+    _elite_frequency = read_doubles(stream);
+    _elite_solution = elite_solution_container();
+    unsigned elite_count = read_value<unsigned>(stream);
+    for (unsigned i = 0; i < elite_count && stream; i++)
+    {
+        double value = read_value<double>(stream);
+        _elite_solution.emplace(value, read_solution(stream, _size));
+    }
+    _solved = true;
+    return stream && _elite_frequency.size() == _size;
+}
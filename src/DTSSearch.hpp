@@ -8,9 +8,24 @@
 
 #include "Heuristic.hpp"
 #include "Matrix.hpp"
+#include "SparseMatrix.hpp"
+#include "TabuPolicy.hpp"
+#include <iostream>
+#include <queue>
 #include <random>
+#include <utility>
 #include <vector>
 
+/// @brief Tunable constants of DTSSearch
+struct DTSSParameters
+{
+    /// @brief Number of elite solutions kept
+    unsigned elite_size = 20;
+    /// @brief Fraction of the variables flipped by a perturbation, in (0, 1]
+    double pick_fraction = 0.1;
+    TabuParameters tabu;
+};
+
 /// @brief Diversification-driven tabu search class
 class DTSSearch : public Heuristic
 {
@@ -33,20 +48,60 @@ public:
     /// @brief Generate data string of current run
     /// @return Data string of iteration run
     std::string get_output() override;
+    /// @brief Preload solutions as elite solutions and start from the best of them
+    /// @param solutions Initial solutions
+    void warm_start(std::vector<std::vector<bool>> const &solutions) override;
+    /// @brief Patch the incumbent and elite objective values in O(changes * elite size)
+    /// @param changes Coefficient differences
+    void update_instance(std::vector<QuboEdit> const &changes) override;
+    /// @brief Write incumbent, elite pool, counters and RNG state
+    /// @param stream Binary output stream
+    void save_checkpoint(std::ostream &stream) override;
+    /// @brief Restore a checkpoint written by save_checkpoint
+    /// @param stream Binary input stream
+    /// @return False if the checkpoint does not match
+    bool load_checkpoint(std::istream &stream) override;
+    /// @brief Replace the search constants, call before the first solve
+    /// @param parameters DTSS parameters
+    void set_parameters(DTSSParameters const &parameters);
 
 private:
+    using elite_solution_container = std::priority_queue<
+        std::pair<double, std::vector<bool>>,
+        std::vector<std::pair<double, std::vector<bool>>>,
+        std::greater<>>;
     std::string output;
     unsigned _size;
     bool _solved;
     Matrix const &_matrix;
     std::vector<bool> _last_solution;
     std::mt19937 _random_engine;
+    std::vector<double> _rank_weight;
+    std::vector<double> _flip_count;
+    std::vector<unsigned> _flipped;
+    double _max_flip;
+    std::vector<bool> _current_solution;
+    elite_solution_container _elite_solution;
+    std::vector<double> _elite_frequency;
+    double _best_found_value;
+    unsigned _iter_count;
+    unsigned _last_update;
+    DTSSParameters _parameters;
+    TabuPolicy _tabu;
+    /// @brief Neighbour lists for pair moves, built on the first search that uses them
+    SparseMatrix _sparse;
     void
     _initialize(std::vector<bool> &current_solution);
     void
     _compute_row_and_column_values(const std::vector<bool> &solution_vector, std::vector<double> &row_value,
                                    std::vector<double> &column_value);
-    auto _inner_search_loop(std::vector<bool> &final_solution, std::vector<double> &flip_count) -> double;
+    /// @brief Offer a solution to the elite pool
+    /// @param solution Solution vector
+    /// @param value Objective value of the solution
+    /// @param changed Receives the variables whose elite frequency changed
+    /// @return True if the pool grew, which changes the score of every variable
+    auto _insert_elite(std::vector<bool> const &solution, double value, std::vector<unsigned> &changed) -> bool;
+    auto _inner_search_loop(std::vector<bool> &final_solution) -> double;
     auto _outer_search_loop(unsigned time_limit) -> void;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "Evaluator.hpp"
+#include "SparseMatrix.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+auto evaluate(SparseMatrix const &matrix, std::vector<bool> const &solution) -> double
+{
+    double result = 0;
+    for (unsigned i = 0; i < matrix.size(); i++)
+    {
+        if (!solution[i])
+        {
+            continue;
+        }
+        result += matrix.diagonal(i);
+        // every term is stored in both rows, count it from its larger index
+        for (auto entry = matrix.begin(i); entry != matrix.end(i); ++entry)
+        {
+            if (entry->column < i && solution[entry->column])
+            {
+                result += entry->value;
+            }
+        }
+    }
+    return result;
+}
+auto evaluate_batch(SparseMatrix const &matrix, std::vector<std::vector<bool>> const &solutions) -> std::vector<double>
+{
+    std::vector<double> result;
+    result.reserve(solutions.size());
+    for (unsigned first = 0; first < solutions.size(); first += 64)
+    {
+        unsigned count = std::min<unsigned>(64, solutions.size() - first);
+        std::vector<double> values = evaluate_bitsliced(matrix, pack_solutions(solutions, first, matrix.size()), count);
+        result.insert(result.end(), values.begin(), values.end());
+    }
+    return result;
+}
+auto pack_solutions(std::vector<std::vector<bool>> const &solutions, unsigned first, unsigned size) -> std::vector<std::uint64_t>
+{
+    std::vector<std::uint64_t> packed(size, 0);
+    unsigned count = std::min<unsigned>(64, solutions.size() - first);
+    for (unsigned s = 0; s < count; s++)
+    {
+        std::vector<bool> const &solution = solutions[first + s];
+        for (unsigned i = 0; i < size; i++)
+        {
+            if (solution[i])
+            {
+                packed[i] |= std::uint64_t(1) << s;
+            }
+        }
+    }
+    return packed;
+}
+auto evaluate_bitsliced(SparseMatrix const &matrix, std::vector<std::uint64_t> const &packed, unsigned count) -> std::vector<double>
+{
+    double value[64] = {};
+    for (unsigned i = 0; i < matrix.size(); i++)
+    {
+        std::uint64_t x_i = packed[i];
+        if (x_i == 0)
+        {
+            continue;
+        }
+        // only the solutions that set both variables of a term pick up its coefficient
+        for (std::uint64_t lanes = x_i; lanes != 0; lanes &= lanes - 1)
+        {
+            value[__builtin_ctzll(lanes)] += matrix.diagonal(i);
+        }
+        for (auto entry = matrix.begin(i); entry != matrix.end(i); ++entry)
+        {
+            if (entry->column >= i)
+            {
+                continue;
+            }
+            double q = entry->value;
+            for (std::uint64_t lanes = x_i & packed[entry->column]; lanes != 0; lanes &= lanes - 1)
+            {
+                value[__builtin_ctzll(lanes)] += q;
+            }
+        }
+    }
+    return std::vector<double>(value, value + count);
+}
@@ -0,0 +1,34 @@
+/**
+ * @file Evaluator.hpp
+ * @author Gennesaret Tjusila
+ * @brief Objective evaluation of solutions on the sparse Q structure
+ */
+#ifndef Evaluator_H
+#define Evaluator_H
+#include "SparseMatrix.hpp"
+#include <cstdint>
+#include <vector>
+
+/// @brief Objective value of a solution in O(n + nnz)
+/// @param matrix Sparse Q matrix
+/// @param solution Solution vector
+/// @return Objective value
+double evaluate(SparseMatrix const &matrix, std::vector<bool> const &solution);
+/// @brief Objective values of many solutions with one pass over Q per 64 solutions
+/// @param matrix Sparse Q matrix
+/// @param solutions Solution vectors
+/// @return Objective value of every solution
+std::vector<double> evaluate_batch(SparseMatrix const &matrix, std::vector<std::vector<bool>> const &solutions);
+/// @brief Pack up to 64 solutions bit-sliced, bit s of word i is variable i of solution first + s
+/// @param solutions Solution vectors
+/// @param first First solution to pack
+/// @param size Problem size
+/// @return One word per variable
+std::vector<std::uint64_t> pack_solutions(std::vector<std::vector<bool>> const &solutions, unsigned first, unsigned size);
+/// @brief Objective values of up to 64 bit-sliced solutions, every coefficient of Q is read once
+/// @param matrix Sparse Q matrix
+/// @param packed Bit-sliced solutions, one word per variable
+/// @param count Number of solutions in the words
+/// @return Objective value of every packed solution
+std::vector<double> evaluate_bitsliced(SparseMatrix const &matrix, std::vector<std::uint64_t> const &packed, unsigned count);
+#endif
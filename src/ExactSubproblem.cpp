@@ -0,0 +1,77 @@
+#include "ExactSubproblem.hpp"
+#include "SparseMatrix.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+auto solve_subproblem(SparseMatrix const &matrix, std::vector<bool> const &solution,
+                      std::vector<double> const &gain, std::vector<unsigned> const &subset,
+                      std::chrono::high_resolution_clock::time_point deadline) -> SubproblemMove
+{
+    unsigned count = std::min<unsigned>(subset.size(), max_subproblem_size);
+    // couplings inside the subset as short lists, a sparse instance leaves few of the k x k pairs
+    std::vector<unsigned> coupling_start(count + 1, 0);
+    std::vector<std::pair<unsigned, double>> coupling;
+    std::vector<double> local_gain(count);
+    std::vector<double> sign(count);
+    for (unsigned a = 0; a < count; a++)
+    {
+        local_gain[a] = gain[subset[a]];
+        sign[a] = 1 - 2 * int(solution[subset[a]]);
+        for (auto entry = matrix.begin(subset[a]); entry != matrix.end(subset[a]); ++entry)
+        {
+            auto position = std::find(subset.begin(), subset.begin() + count, entry->column);
+            if (position != subset.begin() + count)
+            {
+                coupling.emplace_back(position - subset.begin(), entry->value);
+            }
+        }
+        coupling_start[a + 1] = coupling.size();
+    }
+
+    // walk the Gray code, assignment t differs from assignment t - 1 in its lowest set bit
+    double value = 0;
+    double best_value = 0;
+    std::uint32_t mask = 0;
+    std::uint32_t best_mask = 0;
+    std::uint64_t t = 1;
+    for (; t < (std::uint64_t(1) << count); t++)
+    {
+        // every visited assignment is a valid answer, so a large subset can stop early
+        if ((t & 0xFFFF) == 0 && std::chrono::high_resolution_clock::now() >= deadline)
+        {
+            break;
+        }
+        unsigned a = 0;
+        while (((t >> a) & 1) == 0)
+        {
+            a++;
+        }
+        value += local_gain[a];
+        for (unsigned index = coupling_start[a]; index < coupling_start[a + 1]; index++)
+        {
+            unsigned b = coupling[index].first;
+            local_gain[b] += sign[b] * sign[a] * coupling[index].second;
+        }
+        local_gain[a] = -local_gain[a];
+        sign[a] = -sign[a];
+        mask ^= std::uint32_t(1) << a;
+        if (value > best_value)
+        {
+            best_value = value;
+            best_mask = mask;
+        }
+    }
+
+    SubproblemMove move{{}, best_value, t - 1};
+    for (unsigned a = 0; a < count; a++)
+    {
+        if ((best_mask >> a) & 1)
+        {
+            move.flips.push_back(subset[a]);
+        }
+    }
+    return move;
+}
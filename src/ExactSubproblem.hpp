@@ -0,0 +1,41 @@
+/**
+ * @file ExactSubproblem.hpp
+ * @author Gennesaret Tjusila
+ * @brief Exact solution of a sub-QUBO of a few variables with all other variables fixed
+ */
+#ifndef ExactSubproblem_H
+#define ExactSubproblem_H
+#include "SparseMatrix.hpp"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/// @brief Largest subset solve_subproblem enumerates
+constexpr unsigned max_subproblem_size = 30;
+
+/// @brief Flips that turn a subset into its best assignment
+struct SubproblemMove
+{
+    std::vector<unsigned> flips;
+    /// @brief Objective gain of the flips, 0 if the current assignment is already best
+    double gain;
+    /// @brief Assignments enumerated, fewer than 2^k - 1 if the deadline cut the enumeration short
+    std::uint64_t evaluated;
+};
+
+/// @brief Best assignment of a subset of variables by Gray code enumeration
+///
+/// Consecutive Gray codes differ in one variable, so every one of the 2^k assignments is reached
+/// by a single flip. A flip of a moves the gain of every subset neighbour b by
+/// (1 - 2x_b)(1 - 2x_a)Q(a, b), which costs O(degree of a in the subset) per assignment and at
+/// most O(k).
+/// @param matrix Sparse Q matrix
+/// @param solution Current solution
+/// @param gain Single flip gains of the current solution
+/// @param subset Variables to reassign, at most max_subproblem_size
+/// @param deadline The enumeration stops here with the best assignment seen so far, checked every 2^16 assignments
+/// @return Flips of the best assignment
+SubproblemMove solve_subproblem(SparseMatrix const &matrix, std::vector<bool> const &solution,
+                                std::vector<double> const &gain, std::vector<unsigned> const &subset,
+                                std::chrono::high_resolution_clock::time_point deadline = std::chrono::high_resolution_clock::time_point::max());
+#endif
@@ -0,0 +1,75 @@
+#include "FenwickTree.hpp"
+#include <vector>
+
+FenwickTree::FenwickTree(unsigned size)
+    : _size{size},
+      _top_step{1},
+      _total{0},
+      _tree(size + 1, 0),
+      _value(size, 0)
+{
+    while (_top_step * 2 <= _size)
+    {
+        _top_step *= 2;
+    }
+}
+FenwickTree::FenwickTree(std::vector<double> const &weights) : FenwickTree(weights.size())
+{
+    for (unsigned i = 0; i < _size; i++)
+    {
+        _value[i] = weights[i];
+        _tree[i + 1] += weights[i];
+        _total += weights[i];
+        // push the partial sum to its parent
+        unsigned parent = (i + 1) + ((i + 1) & -(i + 1));
+        if (parent <= _size)
+        {
+            _tree[parent] += _tree[i + 1];
+        }
+    }
+}
+auto FenwickTree::add(unsigned index, double delta) -> void
+{
+    _value[index] += delta;
+    _total += delta;
+    for (unsigned i = index + 1; i <= _size; i += i & -i)
+    {
+        _tree[i] += delta;
+    }
+}
+auto FenwickTree::find(double target) const -> unsigned
+{
+    unsigned position = 0;
+    for (unsigned step = _top_step; step > 0; step /= 2)
+    {
+        if (position + step <= _size && _tree[position + step] <= target)
+        {
+            position += step;
+            target -= _tree[position];
+        }
+    }
+    // rounding in the partial sums can run past the last weight or land on an empty one
+    while (position > 0 && (position >= _size || _value[position] <= 0))
+    {
+        position--;
+    }
+    return position;
+}
+auto FenwickTree::find_difference(double target, double scale, FenwickTree const &subtracted) const -> unsigned
+{
+    // the partial sums of the difference are the differences of the partial sums
+    unsigned position = 0;
+    for (unsigned step = _top_step; step > 0; step /= 2)
+    {
+        if (position + step <= _size && scale * _tree[position + step] - subtracted._tree[position + step] <= target)
+        {
+            position += step;
+            target -= scale * _tree[position] - subtracted._tree[position];
+        }
+    }
+    while (position > 0 && (position >= _size || scale * _value[position] - subtracted._value[position] <= 0))
+    {
+        position--;
+    }
+    return position;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file FenwickTree.hpp
+ * @author Gennesaret Tjusila
+ * @brief A Fenwick (binary indexed) tree over nonnegative weights
+ */
+#ifndef FenwickTree_H
+#define FenwickTree_H
+#include <vector>
+
+/// @brief Prefix sums and weighted index lookup in O(log n)
+class FenwickTree
+{
+public:
+    /// @brief Create a tree of zero weights
+    /// @param size Number of weights
+    FenwickTree(unsigned size);
+    /// @brief Build a tree from initial weights in O(n)
+    /// @param weights Initial weights
+    FenwickTree(std::vector<double> const &weights);
+    unsigned size() const
+    {
+        return _size;
+    }
+    /// @brief Add to a weight
+    /// @param index Weight index
+    /// @param delta Value to add
+    void add(unsigned index, double delta);
+    /// @brief Get a single weight
+    double value(unsigned index) const
+    {
+        return _value[index];
+    }
+    /// @brief Sum of all weights
+    double total() const
+    {
+        return _total;
+    }
+    /// @brief Find the index whose cumulative weight interval contains target
+    /// @param target Value in [0, total())
+    /// @return Smallest index i with weight(0) + ... + weight(i) > target
+    unsigned find(double target) const;
+    /// @brief Find like find() in the weights scale * weight(i) - subtracted.weight(i), which have to be nonnegative
+    /// @param target Value in [0, scale * total() - subtracted.total())
+    /// @param scale Factor of the own weights
+    /// @param subtracted Tree of the same size
+    /// @return Smallest index i whose cumulative difference exceeds target
+    unsigned find_difference(double target, double scale, FenwickTree const &subtracted) const;
+
+private:
+    unsigned _size;
+    unsigned _top_step;
+    double _total;
+    std::vector<double> _tree;
+    std::vector<double> _value;
+};
+#endif
@@ -1,11 +1,20 @@
 #ifndef Heuristic_H
 #define Heuristic_H
+#include "Checkpoint.hpp"
+#include "Instrumentation.hpp"
+#include "Matrix.hpp"
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <utility>
 #include <vector>
 #include <string>
 /// @brief Abstract Heuristic class
 class Heuristic
 {
 public:
+    virtual ~Heuristic() = default;
     /// @brief Solve Qubo problem with heuristic
     /// @param time_limit Computation time limit
     virtual void solve(unsigned time_limit) = 0;
@@ -15,5 +24,105 @@ public:
     /// @brief Get iteration data string
     /// @return Iteration data string
     virtual std::string get_output() = 0;
+    /// @brief Start the next solve from supplied solutions instead of a random vector
+    /// @param solutions Initial solutions, the best one is used as starting point
+    virtual void warm_start(std::vector<std::vector<bool>> const &solutions) = 0;
+    /// @brief Patch the search state after the Q matrix was changed, the next solve continues from it
+    /// @param changes Coefficient differences as returned by Matrix::apply on the solver's matrix
+    virtual void update_instance(std::vector<QuboEdit> const &changes) = 0;
+    /// @brief Write the search state to a binary checkpoint
+    /// @param stream Binary output stream
+    virtual void save_checkpoint(std::ostream &stream) = 0;
+    /// @brief Restore the search state of a checkpoint, the next solve continues from it
+    /// @param stream Binary input stream
+    /// @return False if the checkpoint does not belong to this solver and problem size
+    virtual bool load_checkpoint(std::istream &stream) = 0;
+    /// @brief Write checkpoints between outer iterations while solving
+    /// @param path Checkpoint file path
+    /// @param interval Seconds between checkpoints, 0 only writes on SIGUSR1/SIGTERM
+    void set_checkpoint(std::string path, unsigned interval)
+    {
+        _checkpoint.enable(path, interval);
+    }
+    /// @brief Stop solving once the best objective reaches a target
+    /// @param target Objective value
+    void set_target(double target)
+    {
+        _has_target = true;
+        _target = target;
+    }
+    /// @brief Called with the incumbent after every outer iteration
+    using IterationCallback = std::function<void(std::vector<bool> const &best_solution, double best_value)>;
+    /// @brief Register the callback called after every outer iteration
+    void set_iteration_callback(IterationCallback callback)
+    {
+        _iteration_callback = callback;
+    }
+    /// @brief Offer a solution found elsewhere, the solver merges it before its next outer iteration
+    /// @param solution Solution vector
+    /// @param value Objective value of the solution
+    void immigrate(std::vector<bool> const &solution, double value)
+    {
+        _migrants.emplace_back(value, solution);
+    }
+    /// @brief Get the counter and phase time summary
+    /// @return Summary, empty unless built with GUMMY_INSTRUMENTATION
+    virtual std::string get_statistics() const
+    {
+#ifdef GUMMY_INSTRUMENTATION
+        return _statistics.summary();
+#else
+        return "";
+#endif
+    }
+
+protected:
+    CheckpointSchedule _checkpoint;
+    SearchStatistics _statistics;
+    bool _has_target = false;
+    double _target = 0;
+    IterationCallback _iteration_callback;
+    /// @brief Solutions of immigrate not merged yet, with their objective values
+    std::vector<std::pair<double, std::vector<bool>>> _migrants;
+    /// @brief Report the incumbent, write a due checkpoint and check the stop conditions
+    /// @param best_solution Best solution found
+    /// @param best_value Its objective value
+    /// @return True if the solver should stop
+    bool _end_of_iteration(std::vector<bool> const &best_solution, double best_value)
+    {
+        if (_iteration_callback)
+        {
+            _iteration_callback(best_solution, best_value);
+        }
+        return this->_checkpoint_if_due() || this->_target_reached(best_value);
+    }
+    /// @brief Check the target of set_target
+    /// @param best_value Best objective value found
+    bool _target_reached(double best_value) const
+    {
+        return _has_target && best_value >= _target;
+    }
+    /// @brief Write the checkpoint file if it is due
+    /// @return True if the solver was asked to stop
+    bool _checkpoint_if_due()
+    {
+        if (_checkpoint.due())
+        {
+            // write next to the old checkpoint first so a kill mid-write never loses it
+            std::string temporary_path = _checkpoint.path() + ".tmp";
+            std::ofstream stream(temporary_path, std::ios::binary);
+            this->save_checkpoint(stream);
+            stream.close();
+            if (stream)
+            {
+                std::rename(temporary_path.c_str(), _checkpoint.path().c_str());
+            }
+            else
+            {
+                std::cerr << "Could not write checkpoint " << _checkpoint.path() << std::endl;
+            }
+        }
+        return _checkpoint.stop_requested();
+    }
 };
-#endif
\ No newline at end of file
+#endif
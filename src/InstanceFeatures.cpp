@@ -0,0 +1,143 @@
+#include "InstanceFeatures.hpp"
+#include "SparseMatrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    auto find_root(std::vector<unsigned> &parent, unsigned i) -> unsigned
+    {
+        while (parent[i] != i)
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+}
+
+auto extract_features(SparseMatrix const &matrix) -> InstanceFeatures
+{
+    InstanceFeatures features;
+    unsigned size = matrix.size();
+    features.size = size;
+    if (size == 0)
+    {
+        return features;
+    }
+    features.density = size > 1 ? matrix.nonzero() / (double(size) * (size - 1)) : 0;
+
+    bool integral = true;
+    double min_coefficient = INFINITY;
+    double max_coefficient = 0;
+    auto add_coefficient = [&](double value)
+    {
+        if (value == 0)
+        {
+            return;
+        }
+        integral = integral && value == std::round(value);
+        min_coefficient = std::min(min_coefficient, std::fabs(value));
+        max_coefficient = std::max(max_coefficient, std::fabs(value));
+    };
+
+    double degree_sum = 0;
+    double degree_square_sum = 0;
+    std::vector<unsigned> parent(size);
+    std::iota(parent.begin(), parent.end(), 0);
+    unsigned components = size;
+    for (unsigned i = 0; i < size; i++)
+    {
+        double degree = matrix.end(i) - matrix.begin(i);
+        degree_sum += degree;
+        degree_square_sum += degree * degree;
+        features.max_degree = std::max(features.max_degree, degree);
+        add_coefficient(matrix.diagonal(i));
+        for (auto entry = matrix.begin(i); entry != matrix.end(i); ++entry)
+        {
+            // every term is stored in both rows, look at it once
+            if (entry->column > i)
+            {
+                continue;
+            }
+            add_coefficient(entry->value);
+            unsigned root_i = find_root(parent, i);
+            unsigned root_j = find_root(parent, entry->column);
+            if (root_i != root_j)
+            {
+                parent[root_i] = root_j;
+                components--;
+            }
+        }
+    }
+    features.mean_degree = degree_sum / size;
+    double variance = std::max(0.0, degree_square_sum / size - features.mean_degree * features.mean_degree);
+    features.degree_variation = features.mean_degree > 0 ? std::sqrt(variance) / features.mean_degree : 0;
+    features.min_coefficient = max_coefficient > 0 ? min_coefficient : 0;
+    features.max_coefficient = max_coefficient;
+    features.integral = integral;
+    features.components = components;
+    return features;
+}
+
+auto feature_names() -> std::vector<std::string>
+{
+    return {"n", "density", "mean_degree", "max_degree", "degree_variation",
+            "min_coefficient", "max_coefficient", "integral", "components"};
+}
+auto get_feature(InstanceFeatures const &features, std::string const &name, bool &known) -> double
+{
+    known = true;
+    if (name == "n")
+    {
+        return features.size;
+    }
+    if (name == "density")
+    {
+        return features.density;
+    }
+    if (name == "mean_degree")
+    {
+        return features.mean_degree;
+    }
+    if (name == "max_degree")
+    {
+        return features.max_degree;
+    }
+    if (name == "degree_variation")
+    {
+        return features.degree_variation;
+    }
+    if (name == "min_coefficient")
+    {
+        return features.min_coefficient;
+    }
+    if (name == "max_coefficient")
+    {
+        return features.max_coefficient;
+    }
+    if (name == "integral")
+    {
+        return features.integral;
+    }
+    if (name == "components")
+    {
+        return features.components;
+    }
+    known = false;
+    return 0;
+}
+auto describe(InstanceFeatures const &features) -> std::string
+{
+    std::ostringstream stream;
+    bool known;
+    for (auto const &name : feature_names())
+    {
+        stream << (name == "n" ? "" : " ") << name << "=" << get_feature(features, name, known);
+    }
+    return stream.str();
+}
@@ -0,0 +1,42 @@
+/**
+ * @file InstanceFeatures.hpp
+ * @author Gennesaret Tjusila
+ * @brief Cheap structural features of a QUBO instance
+ */
+#ifndef InstanceFeatures_H
+#define InstanceFeatures_H
+#include "SparseMatrix.hpp"
+#include <string>
+#include <vector>
+
+/// @brief Structural features computed in O(n + nnz)
+struct InstanceFeatures
+{
+    /// @brief Number of variables
+    double size = 0;
+    /// @brief Fraction of nonzero off-diagonal terms
+    double density = 0;
+    /// @brief Mean, maximum and coefficient of variation of the number of neighbours
+    double mean_degree = 0;
+    double max_degree = 0;
+    double degree_variation = 0;
+    /// @brief Smallest and largest nonzero coefficient magnitude
+    double min_coefficient = 0;
+    double max_coefficient = 0;
+    /// @brief 1 if every coefficient is an integer
+    double integral = 0;
+    /// @brief Connected components of the interaction graph, isolated variables included
+    double components = 0;
+};
+
+/// @brief Compute the features of an instance
+/// @param matrix Sparse Q matrix
+InstanceFeatures extract_features(SparseMatrix const &matrix);
+/// @brief Names of the features, as used in selection rules
+std::vector<std::string> feature_names();
+/// @brief Get a feature by name
+/// @param known Set to false for an unknown name
+double get_feature(InstanceFeatures const &features, std::string const &name, bool &known);
+/// @brief Space separated name=value list of all features
+std::string describe(InstanceFeatures const &features);
+#endif
@@ -0,0 +1,145 @@
+#include "Instrumentation.hpp"
+#include <iomanip>
+#include <sstream>
+#include <string>
+#ifdef GUMMY_PERF_COUNTERS
+#include <cstdint>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef GUMMY_PERF_COUNTERS
+namespace
+{
+    /// @brief One perf_event_open group of all PerfEvent counters, opened on first use
+    class PerfCounterGroup
+    {
+    public:
+        PerfCounterGroup()
+        {
+            std::uint64_t configs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                       PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+            for (unsigned event = 0; event < static_cast<unsigned>(PerfEvent::count); event++)
+            {
+                perf_event_attr attributes;
+                std::memset(&attributes, 0, sizeof(attributes));
+                attributes.type = PERF_TYPE_HARDWARE;
+                attributes.size = sizeof(attributes);
+                attributes.config = configs[event];
+                attributes.read_format = PERF_FORMAT_GROUP;
+                attributes.disabled = _leader == -1;
+                // user space only, so perf_event_paranoid up to 2 allows it without root
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+                int descriptor = syscall(SYS_perf_event_open, &attributes, 0, -1, _leader, 0);
+                if (descriptor == -1)
+                {
+                    continue;
+                }
+                if (_leader == -1)
+                {
+                    _leader = descriptor;
+                }
+                _descriptors[event] = descriptor;
+                _events[_opened++] = event;
+            }
+            if (_leader != -1)
+            {
+                ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+        }
+        ~PerfCounterGroup()
+        {
+            for (int descriptor : _descriptors)
+            {
+                if (descriptor != -1)
+                {
+                    close(descriptor);
+                }
+            }
+        }
+        auto read(unsigned long long values[]) -> bool
+        {
+            if (_leader == -1)
+            {
+                return false;
+            }
+            // group read format: number of counters followed by their values in opening order
+            std::uint64_t buffer[1 + static_cast<unsigned>(PerfEvent::count)] = {};
+            if (::read(_leader, buffer, sizeof(buffer)) <= 0)
+            {
+                return false;
+            }
+            for (unsigned i = 0; i < buffer[0] && i < _opened; i++)
+            {
+                values[_events[i]] = buffer[1 + i];
+            }
+            return true;
+        }
+
+    private:
+        int _leader = -1;
+        int _descriptors[static_cast<unsigned>(PerfEvent::count)] = {-1, -1, -1, -1};
+        unsigned _events[static_cast<unsigned>(PerfEvent::count)] = {};
+        unsigned _opened = 0;
+    };
+
+    auto perf_counter_group() -> PerfCounterGroup &
+    {
+        static PerfCounterGroup group;
+        return group;
+    }
+}
+#endif
+
+auto read_perf_counters(unsigned long long values[]) -> bool
+{
+#ifdef GUMMY_PERF_COUNTERS
+    return perf_counter_group().read(values);
+#else
+    (void)values;
+    return false;
+#endif
+}
+
+auto SearchStatistics::summary() const -> std::string
+{
+    char const *phase_names[] = {"scan", "update", "perturbation", "elite", "logging"};
+    std::ostringstream stream;
+    stream << "Moves evaluated: " << moves_evaluated << "\n"
+           << "Flips applied: " << flips_applied << "\n"
+           << "Tabu rejections: " << tabu_rejections << "\n"
+           << "Aspiration hits: " << aspiration_hits << "\n"
+           << "Pair moves: " << pair_moves << "\n"
+           << "Restarts: " << restarts << "\n";
+    for (unsigned phase = 0; phase < static_cast<unsigned>(Phase::count); phase++)
+    {
+        stream << "Phase " << phase_names[phase] << ": "
+               << std::setprecision(3) << std::fixed << phase_seconds[phase] << "s\n";
+    }
+#ifdef GUMMY_PERF_COUNTERS
+    unsigned long long probe[static_cast<unsigned>(PerfEvent::count)] = {};
+    if (!read_perf_counters(probe))
+    {
+        stream << "Hardware counters unavailable, check /proc/sys/kernel/perf_event_paranoid\n";
+        return stream.str();
+    }
+    for (unsigned phase = 0; phase < static_cast<unsigned>(Phase::count); phase++)
+    {
+        unsigned long long const *events = phase_events[phase];
+        unsigned long long cycles = events[static_cast<unsigned>(PerfEvent::cycles)];
+        unsigned long long instructions = events[static_cast<unsigned>(PerfEvent::instructions)];
+        stream << "Phase " << phase_names[phase] << " counters:"
+               << " cycles " << cycles
+               << " instructions " << instructions
+               << " IPC " << std::setprecision(2) << (cycles > 0 ? double(instructions) / cycles : 0.0)
+               << " LLC misses " << events[static_cast<unsigned>(PerfEvent::cache_misses)]
+               << " branch misses " << events[static_cast<unsigned>(PerfEvent::branch_misses)] << "\n";
+    }
+#endif
+    return stream.str();
+}
@@ -0,0 +1,100 @@
+/**
+ * @file Instrumentation.hpp
+ * @author Gennesaret Tjusila
+ * @brief Hot path counters and phase timers, compiled in with -DGUMMY_INSTRUMENTATION=ON,
+ * -DGUMMY_PERF_COUNTERS=ON additionally reads hardware counters per phase
+ */
+#ifndef Instrumentation_H
+#define Instrumentation_H
+#include <chrono>
+#include <string>
+
+/// @brief Solver phases with their own cumulative timer
+enum class Phase
+{
+    scan,
+    update,
+    perturbation,
+    elite,
+    logging,
+    count
+};
+
+/// @brief Hardware events read per phase with perf_event_open
+enum class PerfEvent
+{
+    cycles,
+    instructions,
+    cache_misses,
+    branch_misses,
+    count
+};
+
+/// @brief Read the hardware counters of the calling thread
+/// @param values Counter values indexed by PerfEvent, unsupported events stay 0
+/// @return False if no counter could be opened (not Linux, or perf_event_paranoid too strict)
+bool read_perf_counters(unsigned long long values[]);
+
+/// @brief Counters and phase times of all solves of a heuristic
+struct SearchStatistics
+{
+    unsigned long long moves_evaluated = 0;
+    unsigned long long flips_applied = 0;
+    unsigned long long tabu_rejections = 0;
+    unsigned long long aspiration_hits = 0;
+    unsigned long long pair_moves = 0;
+    unsigned long long restarts = 0;
+    double phase_seconds[static_cast<unsigned>(Phase::count)] = {};
+    unsigned long long phase_events[static_cast<unsigned>(Phase::count)][static_cast<unsigned>(PerfEvent::count)] = {};
+    /// @brief Human readable summary, one line per counter and phase
+    std::string summary() const;
+};
+
+/// @brief Adds the lifetime of its scope to a phase timer
+class PhaseTimer
+{
+public:
+    PhaseTimer(SearchStatistics &statistics, Phase phase)
+        : _statistics(statistics),
+          _phase(phase),
+          _start(std::chrono::steady_clock::now())
+    {
+#ifdef GUMMY_PERF_COUNTERS
+        read_perf_counters(_start_events);
+#endif
+    }
+    ~PhaseTimer()
+    {
+#ifdef GUMMY_PERF_COUNTERS
+        unsigned long long end_events[static_cast<unsigned>(PerfEvent::count)] = {};
+        read_perf_counters(end_events);
+        for (unsigned event = 0; event < static_cast<unsigned>(PerfEvent::count); event++)
+        {
+            _statistics.phase_events[static_cast<unsigned>(_phase)][event] += end_events[event] - _start_events[event];
+        }
+#endif
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _start;
+        _statistics.phase_seconds[static_cast<unsigned>(_phase)] += elapsed.count();
+    }
+
+private:
+    SearchStatistics &_statistics;
+    Phase _phase;
+    std::chrono::steady_clock::time_point _start;
+#ifdef GUMMY_PERF_COUNTERS
+    unsigned long long _start_events[static_cast<unsigned>(PerfEvent::count)] = {};
+#endif
+};
+
+#ifdef GUMMY_INSTRUMENTATION
+#define GUMMY_CONCATENATE_INNER(a, b) a##b
+#define GUMMY_CONCATENATE(a, b) GUMMY_CONCATENATE_INNER(a, b)
+/// @brief Add to a counter of a SearchStatistics
+#define GUMMY_COUNT(statistics, counter, amount) ((statistics).counter += (amount))
+/// @brief Time the rest of the enclosing scope as a phase
+#define GUMMY_PHASE(statistics, phase) PhaseTimer GUMMY_CONCATENATE(phase_timer_, __LINE__)((statistics), (phase))
+#else
+#define GUMMY_COUNT(statistics, counter, amount) ((void)0)
+#define GUMMY_PHASE(statistics, phase) ((void)0)
+#endif
+#endif
@@ -0,0 +1,193 @@
+#include "Island.hpp"
+#include "Checkpoint.hpp"
+#include "Evaluator.hpp"
+#include "Heuristic.hpp"
+#include "SparseMatrix.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    char const island_magic[8] = {'G', 'U', 'M', 'M', 'Y', 'I', 'S', '1'};
+}
+
+auto resolve_address(std::string const &address, std::vector<char> &resolved, std::string &error) -> bool
+{
+    if (address.find('/') != std::string::npos)
+    {
+        sockaddr_un unix_address{};
+        if (address.size() >= sizeof(unix_address.sun_path))
+        {
+            error = "socket path too long: " + address;
+            return false;
+        }
+        unix_address.sun_family = AF_UNIX;
+        std::strcpy(unix_address.sun_path, address.c_str());
+        resolved.assign(reinterpret_cast<char *>(&unix_address), reinterpret_cast<char *>(&unix_address) + sizeof(unix_address));
+        return true;
+    }
+    auto separator = address.rfind(':');
+    if (separator == std::string::npos)
+    {
+        error = "expected host:port or a socket path: " + address;
+        return false;
+    }
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *result = nullptr;
+    std::string host = address.substr(0, separator);
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), address.substr(separator + 1).c_str(), &hints, &result) != 0 || result == nullptr)
+    {
+        error = "cannot resolve " + address;
+        return false;
+    }
+    resolved.assign(reinterpret_cast<char *>(result->ai_addr), reinterpret_cast<char *>(result->ai_addr) + result->ai_addrlen);
+    freeaddrinfo(result);
+    return true;
+}
+
+IslandLink::IslandLink(std::string const &address, std::vector<std::string> const &peers)
+    : _socket{-1}, _unix_path(), _peers(), _error()
+{
+    std::vector<char> own;
+    if (!resolve_address(address, own, _error))
+    {
+        return;
+    }
+    for (auto const &peer : peers)
+    {
+        std::vector<char> resolved;
+        if (!resolve_address(peer, resolved, _error))
+        {
+            return;
+        }
+        if (reinterpret_cast<sockaddr const *>(resolved.data())->sa_family != reinterpret_cast<sockaddr const *>(own.data())->sa_family)
+        {
+            _error = "peer " + peer + " does not use the transport of " + address;
+            return;
+        }
+        _peers.push_back(resolved);
+    }
+    int family = reinterpret_cast<sockaddr const *>(own.data())->sa_family;
+    int descriptor = socket(family, SOCK_DGRAM, 0);
+    if (descriptor == -1)
+    {
+        _error = "cannot create socket";
+        return;
+    }
+    if (family == AF_UNIX)
+    {
+        // a path left behind by an earlier run would make bind fail
+        _unix_path = address;
+        unlink(_unix_path.c_str());
+    }
+    if (bind(descriptor, reinterpret_cast<sockaddr const *>(own.data()), own.size()) == -1)
+    {
+        _error = "cannot bind " + address + ": " + std::strerror(errno);
+        close(descriptor);
+        return;
+    }
+    fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+    _socket = descriptor;
+}
+IslandLink::~IslandLink()
+{
+    if (_socket != -1)
+    {
+        close(_socket);
+    }
+    if (!_unix_path.empty())
+    {
+        unlink(_unix_path.c_str());
+    }
+}
+auto IslandLink::send(std::vector<bool> const &solution, double value) -> unsigned
+{
+    std::ostringstream message;
+    message.write(island_magic, sizeof(island_magic));
+    write_value<double>(message, value);
+    write_solution(message, solution);
+    std::string bytes = message.str();
+    unsigned sent = 0;
+    for (auto const &peer : _peers)
+    {
+        if (sendto(_socket, bytes.data(), bytes.size(), 0, reinterpret_cast<sockaddr const *>(peer.data()), peer.size()) == ssize_t(bytes.size()))
+        {
+            sent++;
+        }
+    }
+    return sent;
+}
+auto IslandLink::receive(unsigned size) -> std::vector<std::pair<double, std::vector<bool>>>
+{
+    std::vector<std::pair<double, std::vector<bool>>> received;
+    // header, value, size and the packed bits
+    std::vector<char> buffer(sizeof(island_magic) + sizeof(double) + sizeof(unsigned) + size / 8 + 1);
+    while (true)
+    {
+        ssize_t length = recv(_socket, buffer.data(), buffer.size(), 0);
+        if (length < 0)
+        {
+            break;
+        }
+        std::istringstream message(std::string(buffer.data(), length));
+        char magic[sizeof(island_magic)] = {};
+        message.read(magic, sizeof(magic));
+        double value = read_value<double>(message);
+        std::vector<bool> solution = read_solution(message, size);
+        if (message && std::equal(magic, magic + sizeof(magic), island_magic))
+        {
+            received.emplace_back(value, solution);
+        }
+    }
+    return received;
+}
+
+IslandExchange::IslandExchange(IslandLink &link, SparseMatrix const &matrix, unsigned interval)
+    : _link(link),
+      _matrix(matrix),
+      _interval(std::chrono::seconds(interval)),
+      _last_exchange(std::chrono::steady_clock::now()),
+      _last_sent_value{0},
+      _sent_any{false},
+      _sent{0},
+      _received{0} {}
+auto IslandExchange::exchange(Heuristic &heuristic, std::vector<bool> const &best_solution, double best_value) -> void
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now - _last_exchange < _interval)
+    {
+        return;
+    }
+    _last_exchange = now;
+    if (!_sent_any || best_value > _last_sent_value)
+    {
+        _sent += _link.send(best_solution, best_value);
+        _last_sent_value = best_value;
+        _sent_any = true;
+    }
+    for (auto const &[claimed_value, solution] : _link.receive(_matrix.size()))
+    {
+        // the sender may run another instance of the same size, trust only our own evaluation
+        (void)claimed_value;
+        _received++;
+        heuristic.immigrate(solution, evaluate(_matrix, solution));
+    }
+}
+auto IslandExchange::summary() const -> std::string
+{
+    return "Island: sent " + std::to_string(_sent) + " solutions, received " + std::to_string(_received);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file Island.hpp
+ * @author Gennesaret Tjusila
+ * @brief Elite exchange between gummy processes over Unix domain or UDP datagram sockets
+ */
+#ifndef Island_H
+#define Island_H
+#include "Heuristic.hpp"
+#include "SparseMatrix.hpp"
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Resolve a socket address
+/// @param address A Unix domain socket path if it contains a '/', host:port for IPv4 otherwise
+/// @param resolved Receives the sockaddr bytes
+/// @param error Receives the reason if resolving failed
+/// @return False if the address is malformed or the host unknown
+bool resolve_address(std::string const &address, std::vector<char> &resolved, std::string &error);
+
+/// @brief A datagram socket bound to one address that sends to a fixed set of peers
+///
+/// An address containing a '/' is a Unix domain socket path, anything else is host:port for UDP.
+class IslandLink
+{
+public:
+    /// @brief Bind the own address and resolve the peers
+    /// @param address Own address
+    /// @param peers Addresses of the other islands
+    IslandLink(std::string const &address, std::vector<std::string> const &peers);
+    ~IslandLink();
+    IslandLink(IslandLink const &) = delete;
+    IslandLink &operator=(IslandLink const &) = delete;
+    /// @brief False if binding or resolving failed, see error()
+    bool ok() const
+    {
+        return _socket != -1;
+    }
+    std::string const &error() const
+    {
+        return _error;
+    }
+    /// @brief Send a solution to every peer, an unreachable peer is skipped
+    /// @return Number of peers it was sent to
+    unsigned send(std::vector<bool> const &solution, double value);
+    /// @brief Receive all pending solutions without blocking
+    /// @param size Expected problem size, other messages are dropped
+    /// @return Solutions with the objective values claimed by their senders
+    std::vector<std::pair<double, std::vector<bool>>> receive(unsigned size);
+
+private:
+    int _socket;
+    std::string _unix_path;
+    std::vector<std::vector<char>> _peers;
+    std::string _error;
+};
+
+/// @brief Exchanges the incumbent of a solver with the other islands at a fixed interval
+class IslandExchange
+{
+public:
+    /// @brief Create an exchange
+    /// @param link Socket to the other islands
+    /// @param matrix Sparse Q matrix, received solutions are evaluated on it
+    /// @param interval Seconds between exchanges
+    IslandExchange(IslandLink &link, SparseMatrix const &matrix, unsigned interval);
+    /// @brief Send the incumbent if it improved and hand received solutions to the solver
+    /// @param heuristic Solver to immigrate into
+    /// @param best_solution Incumbent of the solver
+    /// @param best_value Its objective value
+    void exchange(Heuristic &heuristic, std::vector<bool> const &best_solution, double best_value);
+    /// @brief Number of sent and received solutions
+    std::string summary() const;
+
+private:
+    IslandLink &_link;
+    SparseMatrix const &_matrix;
+    std::chrono::steady_clock::duration _interval;
+    std::chrono::steady_clock::time_point _last_exchange;
+    double _last_sent_value;
+    bool _sent_any;
+    unsigned long _sent;
+    unsigned long _received;
+};
+#endif
@@ -1,5 +1,11 @@
 #include "MSTSearch.hpp"
+#include "Checkpoint.hpp"
+#include "ExactSubproblem.hpp"
 #include "Matrix.hpp"
+#include "FenwickTree.hpp"
+#include "Instrumentation.hpp"
+#include "PairMoves.hpp"
+#include "SparseMatrix.hpp"
 #include <iostream>
 #include <random>
 #include <vector>
@@ -7,33 +13,78 @@
 #include <climits>
 #include <chrono>
 #include <fstream>
+#include <queue>
+#include <utility>
 
 MSTSearch::MSTSearch(Matrix const &matrix, unsigned size)
     : MSTSearch(matrix, size, std::random_device()()) {}
 
 MSTSearch::MSTSearch(Matrix const &matrix, unsigned size, unsigned seed)
-    : _matrix{matrix},
-      _size{size},
-      output(),
-      _delta_x(size, 0),
+    : _size{size},
+      _best_value{INT_MIN},
+      _matrix{matrix},
+      _sparse(matrix),
       _row_value(size, 0),
       _column_value(size, 0),
+      _delta_x(size, 0),
       _current_solution(size, false),
       _best_solution(size, false),
-      _random_engine(seed) {}
+      _random_engine(seed),
+      output(),
+      _iter_count{0},
+      _last_update{0},
+      _initialized{false},
+      _warm_started{false},
+      _parameters(),
+      _tabu(size) {}
+
+auto MSTSearch::set_parameters(MSTSParameters const &parameters) -> void
+{
+    _parameters = parameters;
+    _tabu = TabuPolicy(_size, parameters.tabu);
+}
 
 auto MSTSearch::initialize() -> void
 {
-    std::uniform_real_distribution<> dis(0, 1.0);
-    for (unsigned i = 0; i < _size; i++)
+    // a warm start keeps the supplied solution
+    if (!_warm_started)
     {
-        if (dis(_random_engine) > 0.5)
+        std::uniform_real_distribution<> dis(0, 1.0);
+        for (unsigned i = 0; i < _size; i++)
         {
-            _current_solution[i] = !_current_solution[i];
+            if (dis(_random_engine) > 0.5)
+            {
+                _current_solution[i] = !_current_solution[i];
+            }
         }
     }
     this->recompute_internal_variables();
 }
+
+auto MSTSearch::warm_start(std::vector<std::vector<bool>> const &solutions) -> void
+{
+    std::vector<bool> best_start;
+    double best_start_value = INT_MIN;
+    for (auto const &solution : solutions)
+    {
+        if (solution.size() != _size)
+        {
+            continue;
+        }
+        _current_solution = solution;
+        this->recompute_internal_variables();
+        if (best_start.empty() || _current_value > best_start_value)
+        {
+            best_start = solution;
+            best_start_value = _current_value;
+        }
+    }
+    if (!best_start.empty())
+    {
+        _current_solution = best_start;
+        _warm_started = true;
+    }
+}
 auto MSTSearch::recompute_internal_variables() -> void
 {
     std::fill(_row_value.begin(), _row_value.end(), 0);
@@ -60,18 +111,14 @@ auto MSTSearch::recompute_internal_variables() -> void
 // STS
 auto MSTSearch::STS() -> void
 {
-    unsigned c = fmin(20, _size / 4);
-    unsigned a = 10000;     
-    std::uniform_int_distribution<std::mt19937::result_type> dist10(1, 10); // distribution in range [1, 10]
     std::vector<bool> current_solution(_current_solution);
     std::vector<bool> best_solution(_current_solution);
     std::vector<double> column_value(_column_value);
     std::vector<double> row_value(_row_value);
 
-    unsigned best_index = -1;
+    unsigned best_index = _size;
     double best_update = 0;
     double delta_i;
-    unsigned last_update = 0;
     int rho;
 
     // Step 1
@@ -79,63 +126,106 @@ auto MSTSearch::STS() -> void
     double best_value = _current_value;
     double current_value = _current_value;
     std::vector<double> tabu_tenure(_size, 0);
+    // single flip gains of the last full scan, the pair moves reuse them
+    std::vector<double> gain(_size, 0);
+    bool pair_moves = _tabu.parameters().pair_moves;
+    _tabu.begin();
 
-    while (iteration_count <= last_update + a)
+    while (_tabu.proceed(iteration_count))
     {
         // Step 2
-        best_index = -1;
+        // best_index stays _size if every variable is tabu, the iteration then only lets tenures run out
+        best_index = _size;
         best_update = INT_MIN;
         rho = 0;
 
         // Step 3
-        for (unsigned i = 0; i < _size; i++)
         {
-            // Step 3.1
-            // if this variable is tabu go to next variable
-            if (tabu_tenure[i] > iteration_count)
+            GUMMY_PHASE(_statistics, Phase::scan);
+            for (unsigned i = 0; i < _size; i++)
             {
-                continue;
-            }
+                // Step 3.3
+                // calculate delta, tabu variables included for the pair moves
+                delta_i = (1 - 2 * current_solution[i]) * (row_value[i] + column_value[i] + _matrix(i, i));
+                gain[i] = delta_i;
+
+                // Step 3.1
+                // if this variable is tabu go to next variable
+                if (tabu_tenure[i] > iteration_count)
+                {
+                    GUMMY_COUNT(_statistics, tabu_rejections, 1);
+                    continue;
+                }
+                GUMMY_COUNT(_statistics, moves_evaluated, 1);
+                // if best solution found
+                if (current_value + delta_i > best_value)
+                {
+                    GUMMY_COUNT(_statistics, aspiration_hits, 1);
+                    best_index = i;
+                    best_update = delta_i;
+                    rho = 1;
+                    break;
+                }
 
-            // Step 3.3
-            // calculate delta
-            delta_i = (1 - 2 * current_solution[i]) * (row_value[i] + column_value[i] + _matrix(i, i));
-            // if best solution found
-            if (current_value + delta_i > best_value)
-            {
-                best_index = i;
-                best_update = delta_i;
-                rho = 1;
-                break;
+                // Step 3.4
+                // find the highest delta
+                if (delta_i > best_update)
+                {
+                    best_index = i;
+                    best_update = delta_i;
+                }
             }
-
-            // Step 3.4
-            // find the highest delta
-            if (delta_i > best_update)
+        }
+        // no single flip improves, a pair of interacting bits may still leave the plateau
+        unsigned pair_index = _size;
+        if (rho == 0 && best_update <= 0 && pair_moves)
+        {
+            GUMMY_PHASE(_statistics, Phase::scan);
+            PairMove pair = best_pair_move(_sparse, current_solution, gain, tabu_tenure, iteration_count, best_value - current_value);
+            if (pair.first != pair.second && pair.gain > best_update)
             {
-                best_index = i;
-                best_update = delta_i;
+                GUMMY_COUNT(_statistics, pair_moves, 1);
+                best_index = pair.first;
+                pair_index = pair.second;
+                best_update = pair.gain;
+                rho = current_value + best_update > best_value;
             }
         }
 
         // Step 4
         // flip the bit
-        for (unsigned i = 0; i < _size; i++)
+        for (unsigned flipped : {best_index, pair_index})
         {
-            if (i < best_index)
+            if (flipped == _size)
             {
-                column_value[i] += (1 - 2 * current_solution[best_index]) * _matrix(best_index, i);
+                continue;
             }
-            else if (i > best_index)
             {
-                row_value[i] += (1 - 2 * current_solution[best_index]) * _matrix(i, best_index);
+                GUMMY_PHASE(_statistics, Phase::update);
+                for (unsigned i = 0; i < _size; i++)
+                {
+                    if (i < flipped)
+                    {
+                        column_value[i] += (1 - 2 * current_solution[flipped]) * _matrix(flipped, i);
+                    }
+                    else if (i > flipped)
+                    {
+                        row_value[i] += (1 - 2 * current_solution[flipped]) * _matrix(i, flipped);
+                    }
+                }
             }
+            current_solution[flipped] = !current_solution[flipped];
+            _tabu.flip(flipped, iteration_count);
+            GUMMY_COUNT(_statistics, flips_applied, 1);
+        }
+        if (best_index != _size)
+        {
+            current_value = current_value + best_update;
         }
-        current_solution[best_index] = !current_solution[best_index];
-        current_value = current_value + best_update;
 
         // Step 5
         // do greedy local search if best solution found
+        GUMMY_PHASE(_statistics, Phase::update);
         while (rho == 1)
         {
             // Local Search
@@ -150,6 +240,7 @@ auto MSTSearch::STS() -> void
                 ++(iteration_count);
 
                 // Step 5.2.2
+                GUMMY_COUNT(_statistics, moves_evaluated, 1);
                 double delta_i_local = (1 - 2 * current_solution[r]) * (row_value[r] + column_value[r] + _matrix(r, r));
                 if (delta_i_local > 0)
                 {
@@ -166,12 +257,14 @@ auto MSTSearch::STS() -> void
                     }
                     current_solution[r] = !current_solution[r];
                     current_value = current_value + delta_i_local;
+                    _tabu.flip(r, iteration_count);
+                    GUMMY_COUNT(_statistics, flips_applied, 1);
                     rho = 1;
                 }
             }
 
             best_value = current_value;
-            last_update = iteration_count;
+            _tabu.improved(iteration_count);
             std::copy(current_solution.begin(), current_solution.end(), best_solution.begin());
 
             // Step 5.3
@@ -183,14 +276,21 @@ auto MSTSearch::STS() -> void
 
         // Step 6
         // the variable becomes tabu
-        tabu_tenure[best_index] = iteration_count + c + dist10(_random_engine);
+        for (unsigned flipped : {best_index, pair_index})
+        {
+            if (flipped != _size)
+            {
+                tabu_tenure[flipped] = iteration_count + _tabu.tenure(_random_engine);
+            }
+        }
 
-        if (iteration_count > last_update + a)
+        if (!_tabu.proceed(iteration_count))
         {
             break;
         }
         iteration_count++;
     }
+    _tabu.end();
     _current_value = best_value;
     std::copy(best_solution.begin(), best_solution.end(), _current_solution.begin());
 }
@@ -198,122 +298,152 @@ auto MSTSearch::STS() -> void
 // SELECT_VARIABLES
 auto MSTSearch::eval_search() -> std::vector<unsigned>
 {
-    std::vector<bool> current_solution(_current_solution);
-    std::vector<double> column_value(_column_value);
-    std::vector<double> row_value(_row_value);
-
-    double alpha = 0.4;
+    double alpha = _parameters.alpha;
     unsigned n_prime = fmax(10, floor(alpha * _size));
     n_prime = fmin(n_prime, _size);
-    double lambda = 5000;
+    double lambda = _parameters.lambda;
 
     std::vector<unsigned> I_star;
-    std::vector<double> d(_size, 0);
+    I_star.reserve(n_prime);
+    std::vector<double> d(_delta_x);
     std::vector<bool> I(_size, true);
-    std::vector<double> e;
-    std::vector<int> e_index;
+
+    // The score of a candidate is affine in d within the groups d <= 0 and d > 0, so both groups
+    // are sampled from a member count and a |d| Fenwick tree
+    FenwickTree non_positive_count(_size);
+    FenwickTree non_positive_magnitude(_size);
+    FenwickTree positive_count(_size);
+    FenwickTree positive_magnitude(_size);
+    auto insert = [&](unsigned j, double sign)
+    {
+        if (d[j] <= 0)
+        {
+            non_positive_count.add(j, sign);
+            non_positive_magnitude.add(j, -sign * d[j]);
+        }
+        else
+        {
+            positive_count.add(j, sign);
+            positive_magnitude.add(j, sign * d[j]);
+        }
+    };
+
+    // d_min and d_max are tracked with lazily cleaned heaps
+    std::priority_queue<std::pair<double, unsigned>> max_heap;
+    std::priority_queue<std::pair<double, unsigned>, std::vector<std::pair<double, unsigned>>, std::greater<>> min_heap;
+    auto is_stale = [&](std::pair<double, unsigned> const &top)
+    {
+        return !I[top.second] || top.first != d[top.second];
+    };
 
     // Step 1
     for (unsigned i = 0; i < _size; ++i)
     {
-        d[i] = (1 - 2 * current_solution[i]) * (row_value[i] + column_value[i] + _matrix(i, i));
+        insert(i, 1);
+        max_heap.emplace(d[i], i);
+        min_heap.emplace(d[i], i);
     }
 
     // Step 2
     // score function
     for (unsigned i = 0; i < n_prime; ++i)
     {
-        double d_min = INT_MAX;
-        double d_max = INT_MIN;
-        for (unsigned j = 0; j < _size; ++j)
+        while (is_stale(max_heap.top()))
         {
-            if (I[j] == true)
-            {
-                d_max = fmax(d_max, d[j]);
-                d_min = fmin(d_min, d[j]);
-            }
+            max_heap.pop();
+        }
+        while (is_stale(min_heap.top()))
+        {
+            min_heap.pop();
         }
+        double d_max = max_heap.top().first;
+        double d_min = min_heap.top().first;
 
-        if (d_max - d_min < 1e-6)
+        // Step 3
+        // draw a variable with probability proportional to its score
+        unsigned k;
+        // rounding in the magnitude trees may point at an already picked variable, draw again then
+        do
         {
-            for (unsigned j = 0; j < _size; ++j)
+            if (d_max - d_min < 1e-6)
             {
-                // check if this variable is picked
-                if (I[j] == true)
+                std::uniform_int_distribution<unsigned> roll(0, _size - i - 1);
+                double u = roll(_random_engine);
+                if (u < non_positive_count.total())
+                {
+                    k = non_positive_count.find(u);
+                }
+                else
                 {
-                    e.push_back(1);
-                    e_index.push_back(j);
+                    k = positive_count.find(u - non_positive_count.total());
                 }
             }
-        }
-        else
-        {
-            for (unsigned j = 0; j < _size; ++j)
+            else
             {
-                // check if this variable is picked
-                if (I[j] == true)
+                // e = 1 - d / d_min for d <= 0 (0 if d_min = 0), e = 1 + lambda * d / d_max for d > 0
+                // the non-positive group weighs sum(1 - |d| / |d_min|) = count - magnitude / |d_min|
+                double non_positive_weight = 0;
+                if (d_min < 0)
                 {
-                    e_index.push_back(j);
-                    if (d[j] <= 0 and d_min < 0)
+                    non_positive_weight = std::max(0.0, non_positive_count.total() + non_positive_magnitude.total() / d_min);
+                }
+                double positive_weight = 0;
+                if (positive_count.total() > 0)
+                {
+                    positive_weight = positive_count.total() + lambda * positive_magnitude.total() / d_max;
+                    // a group of d_min only is weightless, what is left of it is rounding in the trees
+                    if (non_positive_weight < 1e-9 * non_positive_count.total())
                     {
-                        e.push_back(1 - d[j] / d_min);
+                        non_positive_weight = 0;
                     }
-                    else if (d[j] == d_min and d_min == 0)
+                }
+                std::uniform_real_distribution<double> roll(0, non_positive_weight + positive_weight);
+                double u = roll(_random_engine);
+                if (u < non_positive_weight)
+                {
+                    // scaled by |d_min| a member weighs |d_min| - |d| >= 0. Without a positive group
+                    // d_max <= 0 is in this group with a weight of at least 1e-6
+                    k = non_positive_count.find_difference(-u * d_min, -d_min, non_positive_magnitude);
+                }
+                else
+                {
+                    u = std::min(u - non_positive_weight, positive_weight);
+                    if (u < positive_count.total())
                     {
-                        e.push_back(0);
+                        k = positive_count.find(u);
                     }
                     else
                     {
-                        e.push_back(1 + lambda * (d[j] / d_max));
+                        k = positive_magnitude.find((u - positive_count.total()) * d_max / lambda);
                     }
                 }
             }
-        }
-
-        // Step 3
-        // assign probability
-        double e_sum = 0;
-        for (unsigned i = 0; i < e.size(); ++i)
-        {
-            e_sum += e[i];
-        }
-        std::vector<double> e_prob;
-        for (unsigned i = 0; i < e.size(); ++i)
-        {
-            e_prob.push_back(e[i] / e_sum);
-        }
-
-        std::mt19937 gen(1);
-
-        std::discrete_distribution<std::size_t> roll{e_prob.begin(), e_prob.end()};
-
-        unsigned k = e_index[roll(gen)];
+        } while (!I[k]);
 
         // Step 4
         // pick variable
         I_star.push_back(k);
+        insert(k, -1);
         I[k] = false;
 
-        // update value
-        for (unsigned i = 0; i < _size; i++)
+        // update value, only the neighbours of k change
+        for (auto entry = _sparse.begin(k); entry != _sparse.end(k); ++entry)
         {
-            if (I[i] == true)
+            unsigned j = entry->column;
+            if (I[j] == true)
             {
-                double testing_1 = 0;
-                double testing_2 = 0;
-                if (current_solution[i] == current_solution[k])
+                insert(j, -1);
+                if (_current_solution[j] == _current_solution[k])
                 {
-                    testing_1 = _matrix(i, k);
-                    testing_2 = _matrix(k, i);
+                    d[j] += entry->value;
                 }
                 else
                 {
-                    testing_1 = -_matrix(i, k);
-                    testing_2 = -_matrix(k, i);
+                    d[j] -= entry->value;
                 }
-                double testing = testing_1 + testing_2;
-
-                d[i] += testing;
+                insert(j, 1);
+                max_heap.emplace(d[j], j);
+                min_heap.emplace(d[j], j);
             }
         }
     }
@@ -455,6 +585,93 @@ auto MSTSearch::eval_descent(std::vector<unsigned> I_star) -> std::vector<unsign
     return flip;
 }
 
+// LARGE NEIGHBOURHOOD SEARCH
+auto MSTSearch::_exact_neighbourhoods(std::chrono::high_resolution_clock::time_point deadline) -> void
+{
+    unsigned count = std::min({_parameters.exact_size, _size, max_subproblem_size});
+    if (count == 0)
+    {
+        return;
+    }
+    // a round costs 2^exact_size steps, the enumeration itself stops at the deadline so a round of 30 does not overrun it
+    for (unsigned round = 0; round < _parameters.exact_rounds && std::chrono::high_resolution_clock::now() < deadline; ++round)
+    {
+        std::vector<unsigned> subset = this->_pick_neighbourhood(count);
+        SubproblemMove move = solve_subproblem(_sparse, _current_solution, _delta_x, subset, deadline);
+        GUMMY_COUNT(_statistics, moves_evaluated, move.evaluated);
+        // rounding of the enumerated values must not count as an improvement
+        if (move.gain <= 1e-9)
+        {
+            continue;
+        }
+        for (unsigned k : move.flips)
+        {
+            GUMMY_COUNT(_statistics, flips_applied, 1);
+            this->_flip(k);
+        }
+    }
+}
+
+auto MSTSearch::_pick_neighbourhood(unsigned count) -> std::vector<unsigned>
+{
+    // interacting variables make a subproblem the enumeration can improve on jointly
+    std::vector<unsigned> subset;
+    std::vector<bool> picked(_size, false);
+    std::uniform_int_distribution<unsigned> variable(0, _size - 1);
+    std::vector<unsigned> neighbours;
+    while (subset.size() < count)
+    {
+        unsigned root = variable(_random_engine);
+        if (picked[root])
+        {
+            continue;
+        }
+        picked[root] = true;
+        std::size_t head = subset.size();
+        subset.push_back(root);
+        for (; head < subset.size() && subset.size() < count; head++)
+        {
+            neighbours.clear();
+            for (auto entry = _sparse.begin(subset[head]); entry != _sparse.end(subset[head]); ++entry)
+            {
+                if (!picked[entry->column])
+                {
+                    neighbours.push_back(entry->column);
+                }
+            }
+            std::shuffle(neighbours.begin(), neighbours.end(), _random_engine);
+            for (unsigned j = 0; j < neighbours.size() && subset.size() < count; j++)
+            {
+                picked[neighbours[j]] = true;
+                subset.push_back(neighbours[j]);
+            }
+        }
+    }
+    return subset;
+}
+
+auto MSTSearch::_flip(unsigned k) -> void
+{
+    double sign = 1 - 2 * int(_current_solution[k]);
+    for (auto entry = _sparse.begin(k); entry != _sparse.end(k); ++entry)
+    {
+        unsigned j = entry->column;
+        double change = sign * entry->value;
+        if (j < k)
+        {
+            _column_value[j] += change;
+        }
+        else
+        {
+            _row_value[j] += change;
+        }
+        _delta_x[j] += (1 - 2 * int(_current_solution[j])) * change;
+    }
+    _current_solution[k] = !_current_solution[k];
+    _current_value += _delta_x[k];
+    _delta_x[k] = -_delta_x[k];
+}
+
 // MST2
 auto MSTSearch::MSTS(unsigned time_limit) -> void
 {
@@ -468,85 +685,129 @@ auto MSTSearch::MSTS(unsigned time_limit) -> void
 
     // std::cout << "Iteration " << iteration_count << "Current Best" << _best_value << std::endl;
 
-    // Step 1
-    this->initialize();
     start_time_inside = std::chrono::high_resolution_clock::now();
-
-    // Step 2
-    this->STS();
-    this->recompute_internal_variables();
-    // std::cout << "Best Local Value " << _current_value << std::endl;
-    if (_current_value > _best_value)
+    // a restored checkpoint continues at Step 3
+    if (!_initialized)
     {
-        _best_value = _current_value;
-        std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
+        // Step 1
+        this->initialize();
+
+        // Step 2
+        this->STS();
+        this->recompute_internal_variables();
+        // std::cout << "Best Local Value " << _current_value << std::endl;
+        if (_current_value > _best_value)
+        {
+            _best_value = _current_value;
+            std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
+        }
+        _initialized = true;
     }
 
-    unsigned iter_count = 0;
-    unsigned last_update = 0;
+    unsigned run_iter_count = 0;
 
     // Step 3
-    while (iter_count < last_update + 100)
+    while (_iter_count < _last_update + 100)
     {
-        if (iter_count > 0)
+        if (run_iter_count > 0)
         {
             start_time_inside = std::chrono::high_resolution_clock::now();
         }   
-        // Step 4
-        std::vector<unsigned> I_star;
-        I_star = this->eval_search();
+        this->_adopt_migrants();
+        {
+            GUMMY_PHASE(_statistics, Phase::perturbation);
+            // Step 4
+            std::vector<unsigned> I_star;
+            I_star = this->eval_search();
 
-        // Step 5
-        std::vector<unsigned> flip = this->eval_descent(I_star);
+            // Step 5
+            std::vector<unsigned> flip = this->eval_descent(I_star);
 
-        // Step 6
-        double summ = 0;
-        for (unsigned i = 0; i < flip.size(); ++i)
-        {
-            unsigned index = i;
-            if (flip[index] == 1)
+            // Step 6
+            double summ = 0;
+            for (unsigned i = 0; i < flip.size(); ++i)
             {
-                double best_update = (1 - 2 * _current_solution[index]) * (_row_value[index] + _column_value[index] + _matrix(index, index));
-                _current_solution[index] = !_current_solution[index];
-                _current_value += best_update;
-                summ += 1;
+                unsigned index = i;
+                if (flip[index] == 1)
+                {
+                    double best_update = (1 - 2 * _current_solution[index]) * (_row_value[index] + _column_value[index] + _matrix(index, index));
+                    _current_solution[index] = !_current_solution[index];
+                    _current_value += best_update;
+                    summ += 1;
+                }
             }
+            this->recompute_internal_variables();
         }
-        this->recompute_internal_variables();
-
         // Step 7
         this->STS();
         this->recompute_internal_variables();
+        this->_exact_neighbourhoods(start_time_ms + std::chrono::seconds(time_limit));
 
         if (_current_value > _best_value)
         {
             _best_value = _current_value;
-            last_update = iter_count;
+            _last_update = _iter_count;
             std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
         }
         
-        ++ iter_count;
+        ++ _iter_count;
+        ++ run_iter_count;
+        GUMMY_COUNT(_statistics, restarts, 1);
 
         duration_ms = (std::chrono::high_resolution_clock::now() - start_time_ms) / 1000;
         duration_inside = (std::chrono::high_resolution_clock::now() - start_time_inside) / 1000;
 
-        output += "Iteration: ";
-        output += std::to_string(iter_count);
-        output += ";Local Best: ";
-        output += std::to_string(_current_value);
-        output += ";Current Best: ";
-        output += std::to_string(_best_value);
-        output += ";time: ";
-        output += std::to_string(duration_inside.count());
-        output += "\n";
+        {
+            GUMMY_PHASE(_statistics, Phase::logging);
+            output += "Iteration: ";
+            output += std::to_string(_iter_count);
+            output += ";Local Best: ";
+            output += std::to_string(_current_value);
+            output += ";Current Best: ";
+            output += std::to_string(_best_value);
+            output += ";time: ";
+            output += std::to_string(duration_inside.count());
+            output += "\n";
+        }
 
-        if (duration_ms.count() + duration_ms.count() / iter_count >= time_limit)
+        if (this->_end_of_iteration(_best_solution, _best_value))
+        {
+            break;
+        }
+        if (duration_ms.count() + duration_ms.count() / run_iter_count >= time_limit)
         {
             break;
         }
     }
 }
 
+auto MSTSearch::_adopt_migrants() -> void
+{
+    // continue from the best solution of another search if it beats the current one
+    bool adopted = false;
+    for (auto const &[value, solution] : _migrants)
+    {
+        if (solution.size() == _size && value > _current_value)
+        {
+            _current_solution = solution;
+            _current_value = value;
+            adopted = true;
+        }
+    }
+    _migrants.clear();
+    if (!adopted)
+    {
+        return;
+    }
+    this->recompute_internal_variables();
+    if (_current_value > _best_value)
+    {
+        _best_value = _current_value;
+        _last_update = _iter_count;
+        std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
+    }
+}
+
 auto MSTSearch::solve(unsigned time_limit) -> void
 {
     this->MSTS(time_limit);
@@ -560,4 +821,58 @@ auto MSTSearch::get_solution() -> std::vector<bool>
 auto MSTSearch::get_output() -> std::string
 {
     return output;
-}
\ No newline at end of file
+}
+auto MSTSearch::save_checkpoint(std::ostream &stream) -> void
+{
+    write_header(stream, "MSTS", _size);
+    write_random_engine(stream, _random_engine);
+    write_solution(stream, _current_solution);
+    write_solution(stream, _best_solution);
+    write_value<double>(stream, _best_value);
+    write_value<unsigned>(stream, _iter_count);
+    write_value<unsigned>(stream, _last_update);
+    _tabu.save(stream);
+}
+
+auto MSTSearch::load_checkpoint(std::istream &stream) -> bool
+{
+    if (!read_header(stream, "MSTS", _size))
+    {
+        return false;
+    }
+    read_random_engine(stream, _random_engine);
+    _current_solution = read_solution(stream, _size);
+    _best_solution = read_solution(stream, _size);
+    _best_value = read_value<double>(stream);
+    _iter_count = read_value<unsigned>(stream);
+    _last_update = read_value<unsigned>(stream);
+    _tabu.load(stream);
+    this->recompute_internal_variables();
+    _initialized = true;
+    return bool(stream);
+}
+
+auto MSTSearch::update_instance(std::vector<QuboEdit> const &changes) -> void
+{
+    for (auto const &change : changes)
+    {
+        unsigned i = change.row;
+        unsigned j = change.column;
+        _sparse.add(change.row, change.column, change.value);
+        if (i == j)
+        {
+            _current_value += change.value * _current_solution[i];
+            _best_value += change.value * _best_solution[i];
+            _delta_x[i] += (1 - 2 * _current_solution[i]) * change.value;
+            continue;
+        }
+        _row_value[i] += change.value * _current_solution[j];
+        _column_value[j] += change.value * _current_solution[i];
+        _current_value += change.value * _current_solution[i] * _current_solution[j];
+        _best_value += change.value * _best_solution[i] * _best_solution[j];
+        _delta_x[i] += (1 - 2 * _current_solution[i]) * change.value * _current_solution[j];
+        _delta_x[j] += (1 - 2 * _current_solution[j]) * change.value * _current_solution[i];
+    }
+    // the changed landscape restarts the stagnation count
+    _last_update = _iter_count;
+}
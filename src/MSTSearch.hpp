@@ -8,8 +8,27 @@
 
 #include "Heuristic.hpp"
 #include "Matrix.hpp"
+#include "SparseMatrix.hpp"
+#include "TabuPolicy.hpp"
+#include <chrono>
+#include <iostream>
 #include <random>
 #include <vector>
+
+/// @brief Tunable constants of MSTSearch
+struct MSTSParameters
+{
+    /// @brief Fraction of the variables selected for the elite descent, in (0, 1]
+    double alpha = 0.4;
+    /// @brief Score weight of improving variables in the selection, at least 0
+    double lambda = 5000;
+    /// @brief Variables of the exactly solved neighbourhoods after every tabu search, 0 disables them, at most 30
+    unsigned exact_size = 0;
+    /// @brief Exactly solved neighbourhoods after every tabu search
+    unsigned exact_rounds = 4;
+    TabuParameters tabu;
+};
+
 class MSTSearch : public Heuristic
 {
 public:
@@ -18,12 +37,29 @@ public:
     void solve(unsigned time_limit) override;
     std::vector<bool> get_solution() override;
     std::string get_output() override;
+    /// @brief Start from the best of the supplied solutions
+    /// @param solutions Initial solutions
+    void warm_start(std::vector<std::vector<bool>> const &solutions) override;
+    /// @brief Patch the gain vectors and objective values in O(changes)
+    /// @param changes Coefficient differences
+    void update_instance(std::vector<QuboEdit> const &changes) override;
+    /// @brief Write incumbent, counters and RNG state
+    /// @param stream Binary output stream
+    void save_checkpoint(std::ostream &stream) override;
+    /// @brief Restore a checkpoint written by save_checkpoint
+    /// @param stream Binary input stream
+    /// @return False if the checkpoint does not match
+    bool load_checkpoint(std::istream &stream) override;
+    /// @brief Replace the search constants, call before the first solve
+    /// @param parameters MSTS parameters
+    void set_parameters(MSTSParameters const &parameters);
 
 private:
     unsigned _size;
     double _best_value;
     double _current_value;
     Matrix const &_matrix;
+    SparseMatrix _sparse;
     std::vector<double> _row_value;
     std::vector<double> _column_value;
     std::vector<double> _delta_x;
@@ -31,12 +67,27 @@ private:
     std::vector<bool> _best_solution;
     std::mt19937 _random_engine;
     std::string output;
+    unsigned _iter_count;
+    unsigned _last_update;
+    bool _initialized;
+    bool _warm_started;
+    MSTSParameters _parameters;
+    TabuPolicy _tabu;
 
     auto MSTS(unsigned time_limit) -> void;
     auto initialize() -> void;
     auto recompute_internal_variables() -> void;
+    /// @brief Continue from an immigrated solution that beats the current one
+    auto _adopt_migrants() -> void;
     auto STS() -> void;
     auto eval_search() -> std::vector<unsigned>;
     auto eval_descent(std::vector<unsigned> I_star) -> std::vector<unsigned>;
+    /// @brief Solve connected neighbourhoods of exact_size variables exactly, all other variables fixed
+    /// @param deadline No further round starts after it
+    auto _exact_neighbourhoods(std::chrono::high_resolution_clock::time_point deadline) -> void;
+    /// @brief Variables reached breadth first from a random variable, topped up randomly
+    auto _pick_neighbourhood(unsigned count) -> std::vector<unsigned>;
+    /// @brief Flip a variable and update the gains of its neighbours in O(degree)
+    auto _flip(unsigned k) -> void;
 };
 #endif
\ No newline at end of file
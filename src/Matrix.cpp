@@ -1,14 +1,120 @@
 #include "Matrix.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <string>
 #include <vector>
 
-Matrix::Matrix(std::vector<std::vector<double>> data, unsigned n) : _data{data}, _size{n} {};
-Matrix::Matrix(unsigned n) : _data(n, std::vector<double>(n, 0)), _size{n} {};
-Matrix::Matrix() : _data{}, _size{0} {};
-double &Matrix::operator()(unsigned row, unsigned column)
+Matrix::Matrix(std::vector<std::vector<double>> data, unsigned n) : _data{data}, _size{n}, _storage{Storage::dense_double}, _rounded{false} {};
+Matrix::Matrix(unsigned n) : Matrix(n, Storage::dense_double){};
+Matrix::Matrix(unsigned n, Storage storage) : _size{n}, _storage{storage}, _rounded{false}
 {
-    return _data[row][column];
+    if (storage == Storage::dense_double)
+    {
+        _data.assign(n, std::vector<double>(n, 0));
+    }
+    else if (storage == Storage::dense_float)
+    {
+        _packed.assign(std::size_t(n) * (n + 1) / 2, 0);
+    }
+    else
+    {
+        _rows.resize(n);
+    }
+};
+Matrix::Matrix() : _data{}, _size{0}, _storage{Storage::dense_double}, _rounded{false} {};
+double Matrix::_lookup(unsigned row, unsigned column) const
+{
+    // the upper triangle of a QUBO is empty
+    if (column > row)
+    {
+        return 0;
+    }
+    if (_storage == Storage::dense_float)
+    {
+        return _packed[std::size_t(row) * (row + 1) / 2 + column];
+    }
+    auto const &entries = _rows[row];
+    auto entry = std::lower_bound(entries.begin(), entries.end(), column, [](Entry const &e, unsigned c)
+                                  { return e.column < c; });
+    return entry != entries.end() && entry->column == column ? entry->value : 0;
+}
+void Matrix::set(unsigned row, unsigned column, double value)
+{
+    if (_storage == Storage::dense_double)
+    {
+        _data[row][column] = value;
+        return;
+    }
+    if (column > row)
+    {
+        std::swap(row, column);
+    }
+    if (_storage == Storage::dense_float)
+    {
+        float narrowed = float(value);
+        _rounded = _rounded || double(narrowed) != value;
+        _packed[std::size_t(row) * (row + 1) / 2 + column] = narrowed;
+        return;
+    }
+    auto &entries = _rows[row];
+    auto entry = std::lower_bound(entries.begin(), entries.end(), column, [](Entry const &e, unsigned c)
+                                  { return e.column < c; });
+    if (entry != entries.end() && entry->column == column)
+    {
+        if (value == 0)
+        {
+            entries.erase(entry);
+        }
+        else
+        {
+            entry->value = value;
+        }
+    }
+    else if (value != 0)
+    {
+        entries.insert(entry, Entry{column, value});
+    }
+}
+std::vector<QuboEdit> Matrix::apply(std::vector<QuboEdit> const &edits)
+{
+    std::vector<QuboEdit> changes;
+    changes.reserve(edits.size());
+    for (auto const &edit : edits)
+    {
+        unsigned row = std::max(edit.row, edit.column);
+        unsigned column = std::min(edit.row, edit.column);
+        double change = edit.value - (*this)(row, column);
+        if (change != 0)
+        {
+            this->set(row, column, edit.value);
+            changes.push_back(QuboEdit{row, column, change});
+        }
+    }
+    return changes;
+}
+std::size_t Matrix::memory(Storage storage, std::size_t n, std::size_t nonzero)
+{
+    // every std::vector costs its three pointers
+    std::size_t const vector_bytes = 3 * sizeof(void *);
+    if (storage == Storage::dense_double)
+    {
+        return n * (n * sizeof(double) + vector_bytes);
+    }
+    if (storage == Storage::dense_float)
+    {
+        return n * (n + 1) / 2 * sizeof(float);
+    }
+    return n * vector_bytes + nonzero * sizeof(Entry);
 }
-double const &Matrix::operator()(unsigned row, unsigned column) const
+std::string Matrix::storage_name(Storage storage)
 {
-    return _data[row][column];
+    if (storage == Storage::dense_double)
+    {
+        return "dense double";
+    }
+    if (storage == Storage::dense_float)
+    {
+        return "dense float";
+    }
+    return "sparse";
 }
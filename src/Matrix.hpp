@@ -5,24 +5,109 @@
  */
 #ifndef Matrix_H
 #define Matrix_H
+#include "Placement.hpp"
+#include <cstddef>
+#include <string>
 #include <vector>
 
+/// @brief A change of one Q coefficient
+struct QuboEdit
+{
+    unsigned row;
+    unsigned column;
+    /// @brief New coefficient (0 removes the term), or the difference to the old one when returned by Matrix::apply
+    double value;
+};
+
 /// @brief A Square matrix class
 class Matrix
 {
 public:
+    /// @brief How the coefficients are held in memory
+    enum class Storage
+    {
+        /// @brief Full n x n doubles
+        dense_double,
+        /// @brief Lower triangle of floats
+        dense_float,
+        /// @brief Sorted lower triangular rows of nonzeros
+        sparse
+    };
     Matrix(std::vector<std::vector<double>> data, unsigned n);
     Matrix(unsigned n);
+    Matrix(unsigned n, Storage storage);
     Matrix();
-    unsigned size()
+    unsigned size() const
     {
         return _size;
     }
-    double &operator()(unsigned row, unsigned column);
-    double const &operator()(unsigned row, unsigned column) const;
+    Storage storage() const
+    {
+        return _storage;
+    }
+    double operator()(unsigned row, unsigned column) const
+    {
+        if (_storage == Storage::dense_double)
+        {
+            return _data[row][column];
+        }
+        return this->_lookup(row, column);
+    }
+    /// @brief Set a coefficient, sparse and float storage only hold the lower triangle
+    void set(unsigned row, unsigned column, double value);
+    /// @brief Visit the nonzero Q(row, j) with j < row in increasing j
+    template <typename F>
+    void for_each_lower(unsigned row, F visit) const
+    {
+        if (_storage == Storage::sparse)
+        {
+            for (auto const &entry : _rows[row])
+            {
+                if (entry.column < row)
+                {
+                    visit(entry.column, entry.value);
+                }
+            }
+            return;
+        }
+        for (unsigned column = 0; column < row; column++)
+        {
+            double value = (*this)(row, column);
+            if (value != 0)
+            {
+                visit(column, value);
+            }
+        }
+    }
+    /// @brief True if a value set in float storage was rounded
+    bool rounded() const
+    {
+        return _rounded;
+    }
+    /// @brief Set coefficients, off-diagonal terms are stored in the lower triangle
+    /// @param edits New coefficients
+    /// @return Difference of every edited coefficient, in lower triangular indices
+    std::vector<QuboEdit> apply(std::vector<QuboEdit> const &edits);
+
+    /// @brief Estimated bytes of a matrix
+    /// @param storage Storage kind
+    /// @param n Problem size
+    /// @param nonzero Stored nonzero terms of the lower triangle including the diagonal
+    static std::size_t memory(Storage storage, std::size_t n, std::size_t nonzero);
+    static std::string storage_name(Storage storage);
 
 private:
+    struct Entry
+    {
+        unsigned column;
+        double value;
+    };
     std::vector<std::vector<double>> _data;
+    std::vector<float, HugePageAllocator<float>> _packed;
+    std::vector<std::vector<Entry>> _rows;
     unsigned _size;
+    Storage _storage;
+    bool _rounded;
+    double _lookup(unsigned row, unsigned column) const;
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,60 @@
+#include "MemoryPlan.hpp"
+#include "Matrix.hpp"
+#include "SparseMatrix.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+auto solver_memory(std::string const &solver, std::size_t n, std::size_t nonzero) -> std::size_t
+{
+    if (solver == "AUTO")
+    {
+        return std::max({solver_memory("DTSS", n, nonzero), solver_memory("MSTS", n, nonzero), solver_memory("SA", n, nonzero)});
+    }
+    // the final evaluation builds the symmetric neighbour lists once
+    std::size_t neighbour_lists = 2 * nonzero * sizeof(SparseMatrix::Entry) + n * (sizeof(double) + 3 * sizeof(unsigned));
+    std::size_t solution_bytes = n / 8 + 1;
+    // per variable doubles of gains, row/column values, tabu tenures and scores, counted from the solvers
+    if (solver == "DTSS")
+    {
+        std::size_t elite_bytes = 20 * (solution_bytes + 64);
+        return neighbour_lists + 14 * n * sizeof(double) + 2 * n * sizeof(unsigned) + elite_bytes + 8 * solution_bytes;
+    }
+    if (solver == "MSTS")
+    {
+        // MSTS keeps its own neighbour lists
+        return 2 * neighbour_lists + 20 * n * sizeof(double) + 2 * n * sizeof(unsigned) + 8 * solution_bytes;
+    }
+    if (solver == "MSA")
+    {
+        // own neighbour lists plus their integer copy, and one 64-bit word of chain states per variable
+        std::size_t integer_lists = 2 * nonzero * (sizeof(unsigned) + sizeof(std::int64_t)) + n * (3 * sizeof(std::int64_t) + 2 * sizeof(unsigned));
+        return 2 * neighbour_lists + integer_lists + n * sizeof(std::uint64_t) + 8 * solution_bytes;
+    }
+    // SA keeps its own neighbour lists and a fixed table of acceptance thresholds
+    return 2 * neighbour_lists + 8 * n * sizeof(double) + ((std::size_t(1) << 10) + 1) * sizeof(double) + n * sizeof(unsigned) + 8 * solution_bytes;
+}
+auto estimate_memory(std::string const &solver, std::size_t n, std::size_t nonzero) -> std::vector<MemoryEstimate>
+{
+    std::vector<MemoryEstimate> estimates;
+    for (auto storage : {Matrix::Storage::dense_double, Matrix::Storage::dense_float, Matrix::Storage::sparse})
+    {
+        // the diagonal is held on top of the quadratic terms
+        estimates.push_back(MemoryEstimate{storage, Matrix::memory(storage, n, nonzero + n), solver_memory(solver, n, nonzero)});
+    }
+    return estimates;
+}
+auto choose_storage(std::size_t limit, std::vector<MemoryEstimate> const &estimates, Matrix::Storage &storage) -> bool
+{
+    for (auto const &estimate : estimates)
+    {
+        if (estimate.total() <= limit)
+        {
+            storage = estimate.storage;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file MemoryPlan.hpp
+ * @author Gennesaret Tjusila
+ * @brief Memory estimates of a run and the choice of a matrix storage under a RAM limit
+ */
+#ifndef MemoryPlan_H
+#define MemoryPlan_H
+#include "Matrix.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// @brief Estimated memory of a run with one matrix storage
+struct MemoryEstimate
+{
+    Matrix::Storage storage;
+    std::size_t matrix_bytes;
+    std::size_t solver_bytes;
+    std::size_t total() const
+    {
+        return matrix_bytes + solver_bytes;
+    }
+};
+
+/// @brief Estimated bytes of the search state of a solver, the largest solver for AUTO
+/// @param solver Solver name
+/// @param n Problem size
+/// @param nonzero Quadratic terms of the instance
+std::size_t solver_memory(std::string const &solver, std::size_t n, std::size_t nonzero);
+/// @brief Estimates of a run for every storage, from the widest to the narrowest
+std::vector<MemoryEstimate> estimate_memory(std::string const &solver, std::size_t n, std::size_t nonzero);
+/// @brief Pick the first storage of estimate_memory whose run fits into a limit
+/// @param limit Bytes available
+/// @param estimates Estimates of estimate_memory
+/// @param storage Receives the chosen storage
+/// @return False if no storage fits
+bool choose_storage(std::size_t limit, std::vector<MemoryEstimate> const &estimates, Matrix::Storage &storage);
+#endif
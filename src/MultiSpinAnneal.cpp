@@ -0,0 +1,534 @@
+#include "MultiSpinAnneal.hpp"
+#include "Checkpoint.hpp"
+#include "Instrumentation.hpp"
+#include "Matrix.hpp"
+#include "SparseMatrix.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /// @brief Bits of the per chain uniforms, acceptance probabilities are multiples of 2^-10
+    constexpr unsigned uniform_bits = 10;
+    /// @brief Counter words at most, the objective range must stay below 2^max_bits
+    constexpr unsigned max_bits = 52;
+
+    /// @brief Number of bits needed to count up to a value
+    auto bit_count(std::uint64_t value) -> unsigned
+    {
+        unsigned bits = 1;
+        while (value >> bits)
+        {
+            bits++;
+        }
+        return bits;
+    }
+
+    /// @brief Add weight times a 0/1 word to a bit-sliced counter, lane by lane
+    /// @param planes Counter words, least significant first
+    /// @param bits Counter words in use, the sum must fit
+    /// @param word Lanes to add to
+    /// @param weight Non-negative amount
+    auto add_weighted(std::uint64_t *planes, unsigned bits, std::uint64_t word, std::uint64_t weight) -> void
+    {
+        for (unsigned shift = 0; weight != 0; shift++, weight >>= 1)
+        {
+            if ((weight & 1) == 0)
+            {
+                continue;
+            }
+            // ripple carry, it dies out after two words on average
+            std::uint64_t carry = word;
+            for (unsigned bit = shift; carry != 0 && bit < bits; bit++)
+            {
+                std::uint64_t next = planes[bit] & carry;
+                planes[bit] ^= carry;
+                carry = next;
+            }
+        }
+    }
+
+    /// @brief Lanes whose bit-sliced counter is at least a constant
+    auto at_least(std::uint64_t const *planes, unsigned bits, std::int64_t constant) -> std::uint64_t
+    {
+        if (constant <= 0)
+        {
+            return ~std::uint64_t(0);
+        }
+        if (constant >> bits)
+        {
+            return 0;
+        }
+        // compare from the most significant word down, lanes leave equal at their first difference
+        std::uint64_t greater = 0;
+        std::uint64_t equal = ~std::uint64_t(0);
+        for (unsigned bit = bits; bit-- > 0;)
+        {
+            if ((constant >> bit) & 1)
+            {
+                equal &= planes[bit];
+            }
+            else
+            {
+                greater |= equal & planes[bit];
+                equal &= ~planes[bit];
+            }
+        }
+        return greater | equal;
+    }
+}
+
+MultiSpinAnneal::MultiSpinAnneal(Matrix const &matrix, unsigned size, unsigned seed)
+    : _matrix{matrix},
+      _output(),
+      _size{size},
+      _parameters(),
+      _temperature{0.1 * size},
+      _run_count{0},
+      _initialized{false},
+      _sparse(matrix),
+      _chains(size, 0),
+      _best_solution(size, false),
+      _best_value{0},
+      _random_engine(seed),
+      _fallback()
+{
+    this->_build();
+}
+
+auto MultiSpinAnneal::integer_scale(SparseMatrix const &sparse) -> unsigned
+{
+    for (unsigned scale = 1; scale <= 1024; scale *= 2)
+    {
+        bool integer = true;
+        double total = 0;
+        for (unsigned i = 0; i < sparse.size() && integer; i++)
+        {
+            double diagonal = scale * sparse.diagonal(i);
+            integer = diagonal == std::round(diagonal);
+            total += std::abs(diagonal);
+            for (auto entry = sparse.begin(i); entry != sparse.end(i) && integer; ++entry)
+            {
+                double weight = scale * entry->value;
+                integer = weight == std::round(weight);
+                total += std::abs(weight) / 2;
+            }
+        }
+        if (integer)
+        {
+            return total < std::ldexp(1.0, max_bits) ? scale : 0;
+        }
+    }
+    return 0;
+}
+
+auto MultiSpinAnneal::_build() -> void
+{
+    _scale = integer_scale(_sparse);
+    // create_heuristic and update_instance only build instances that pass integer_scale
+    assert(_scale != 0);
+    _diagonal.assign(_size, 0);
+    _neighbour_start.assign(_size + 1, 0);
+    _neighbour.clear();
+    _weight.clear();
+    _field_bits.assign(_size, 1);
+    _negative_sum.assign(_size, 0);
+    _negative_total = 0;
+    _max_gain = 0;
+    std::uint64_t absolute_total = 0;
+    for (unsigned i = 0; i < _size; i++)
+    {
+        _diagonal[i] = std::llround(_scale * _sparse.diagonal(i));
+        absolute_total += std::llabs(_diagonal[i]);
+        _negative_total += std::min<std::int64_t>(_diagonal[i], 0);
+        std::uint64_t absolute_sum = 0;
+        for (auto entry = _sparse.begin(i); entry != _sparse.end(i); ++entry)
+        {
+            std::int64_t weight = std::llround(_scale * entry->value);
+            _neighbour.push_back(entry->column);
+            _weight.push_back(weight);
+            absolute_sum += std::llabs(weight);
+            _negative_sum[i] += std::max<std::int64_t>(-weight, 0);
+            // every pair is stored twice, count it from its larger index
+            if (entry->column < i)
+            {
+                absolute_total += std::llabs(weight);
+                _negative_total += std::min<std::int64_t>(weight, 0);
+            }
+        }
+        _neighbour_start[i + 1] = _neighbour.size();
+        _field_bits[i] = bit_count(absolute_sum);
+        // integer_scale keeps the objective range, and with it every counter, below 2^max_bits
+        assert(_field_bits[i] <= max_bits);
+        _max_gain = std::max<std::int64_t>(_max_gain, absolute_sum + std::llabs(_diagonal[i]));
+    }
+    _value_bits = bit_count(absolute_total);
+    assert(_value_bits <= max_bits);
+}
+
+auto MultiSpinAnneal::set_parameters(SAParameters const &parameters) -> void
+{
+    _parameters = parameters;
+    _temperature = parameters.initial_temperature > 0 ? parameters.initial_temperature : 0.1 * _size;
+}
+
+auto MultiSpinAnneal::_random_word() -> std::uint64_t
+{
+    std::uint64_t high = _random_engine();
+    return (high << 32) | _random_engine();
+}
+
+auto MultiSpinAnneal::_sweep(double temperature) -> bool
+{
+    // fixed point probability of accepting a gain of -d, for d = 0 up to the first that rounds to 0
+    double scaled_temperature = temperature * _scale;
+    _acceptance.clear();
+    for (std::int64_t d = 0; d <= _max_gain; d++)
+    {
+        auto probability = std::uint64_t(std::ldexp(std::exp(-d / scaled_temperature), uniform_bits));
+        if (probability == 0)
+        {
+            break;
+        }
+        _acceptance.push_back(probability);
+    }
+
+    std::uint64_t field[max_bits];
+    std::uint64_t uniform[uniform_bits];
+    std::uint64_t improved = 0;
+    for (unsigned i = 0; i < _size; i++)
+    {
+        GUMMY_COUNT(_statistics, moves_evaluated, 64);
+        unsigned bits = _field_bits[i];
+        std::fill(field, field + bits, 0);
+        // counter = sum of |w| x_j over positive and |w| (1 - x_j) over negative neighbours
+        for (unsigned index = _neighbour_start[i]; index < _neighbour_start[i + 1]; index++)
+        {
+            std::int64_t weight = _weight[index];
+            std::uint64_t word = _chains[_neighbour[index]];
+            add_weighted(field, bits, weight < 0 ? ~word : word, std::llabs(weight));
+        }
+        // the gain of x_i = 0 is counter + offset, the gain of x_i = 1 its negation
+        std::int64_t offset = _diagonal[i] - _negative_sum[i];
+        std::uint64_t chain = _chains[i];
+        auto gain_at_least = [&](std::int64_t gain)
+        {
+            return (~chain & at_least(field, bits, gain - offset)) | (chain & ~at_least(field, bits, -gain - offset + 1));
+        };
+
+        std::uint64_t accept = gain_at_least(1);
+        improved |= accept;
+        if (~accept != 0 && !_acceptance.empty())
+        {
+            for (auto &word : uniform)
+            {
+                word = this->_random_word();
+            }
+            // a chain with gain -d accepts if its uniform is below the probability of -d
+            for (std::int64_t d = 0; d < std::int64_t(_acceptance.size()); d++)
+            {
+                std::uint64_t reached = gain_at_least(-d);
+                accept |= reached & ~at_least(uniform, uniform_bits, _acceptance[d]);
+                if (reached == ~std::uint64_t(0))
+                {
+                    break;
+                }
+            }
+        }
+        GUMMY_COUNT(_statistics, flips_applied, std::bitset<64>(accept).count());
+        _chains[i] = chain ^ accept;
+    }
+    return improved != 0;
+}
+
+auto MultiSpinAnneal::_values() const -> std::vector<std::int64_t>
+{
+    std::vector<std::uint64_t> planes(_value_bits, 0);
+    for (unsigned i = 0; i < _size; i++)
+    {
+        std::uint64_t chain = _chains[i];
+        add_weighted(planes.data(), _value_bits, _diagonal[i] < 0 ? ~chain : chain, std::llabs(_diagonal[i]));
+        for (unsigned index = _neighbour_start[i]; index < _neighbour_start[i + 1]; index++)
+        {
+            unsigned j = _neighbour[index];
+            if (j < i)
+            {
+                std::uint64_t both = chain & _chains[j];
+                add_weighted(planes.data(), _value_bits, _weight[index] < 0 ? ~both : both, std::llabs(_weight[index]));
+            }
+        }
+    }
+    std::vector<std::int64_t> values(64, _negative_total);
+    for (unsigned bit = 0; bit < _value_bits; bit++)
+    {
+        for (unsigned lane = 0; lane < 64; lane++)
+        {
+            values[lane] += std::int64_t((planes[bit] >> lane) & 1) << bit;
+        }
+    }
+    return values;
+}
+
+auto MultiSpinAnneal::_update_best(std::vector<std::int64_t> const &values) -> void
+{
+    unsigned best_lane = std::max_element(values.begin(), values.end()) - values.begin();
+    double value = double(values[best_lane]) / _scale;
+    if (value <= _best_value)
+    {
+        return;
+    }
+    _best_value = value;
+    for (unsigned i = 0; i < _size; i++)
+    {
+        _best_solution[i] = (_chains[i] >> best_lane) & 1;
+    }
+}
+
+auto MultiSpinAnneal::_set_chain(unsigned chain, std::vector<bool> const &solution) -> void
+{
+    for (unsigned i = 0; i < _size; i++)
+    {
+        _chains[i] = (_chains[i] & ~(std::uint64_t(1) << chain)) | (std::uint64_t(solution[i]) << chain);
+    }
+}
+
+auto MultiSpinAnneal::warm_start(std::vector<std::vector<bool>> const &solutions) -> void
+{
+    if (_scale == 0)
+    {
+        this->_start_fallback();
+        _fallback->warm_start(solutions);
+        return;
+    }
+    for (auto &word : _chains)
+    {
+        word = this->_random_word();
+    }
+    unsigned chain = 0;
+    for (auto const &solution : solutions)
+    {
+        if (solution.size() == _size && chain < 64)
+        {
+            this->_set_chain(chain++, solution);
+        }
+    }
+    _best_value = -INFINITY;
+    this->_update_best(this->_values());
+    _initialized = true;
+}
+
+auto MultiSpinAnneal::_adopt_migrants() -> void
+{
+    if (_migrants.empty())
+    {
+        return;
+    }
+    // a migrant replaces the worst chain if it beats it
+    std::vector<std::int64_t> values = this->_values();
+    for (auto const &[value, solution] : _migrants)
+    {
+        unsigned worst_lane = std::min_element(values.begin(), values.end()) - values.begin();
+        if (solution.size() == _size && value * _scale > values[worst_lane])
+        {
+            this->_set_chain(worst_lane, solution);
+            values[worst_lane] = std::llround(value * _scale);
+            if (value > _best_value)
+            {
+                _best_value = value;
+                _best_solution = solution;
+            }
+        }
+    }
+    _migrants.clear();
+}
+
+auto MultiSpinAnneal::_start_fallback() -> void
+{
+    if (_fallback)
+    {
+        return;
+    }
+    _fallback = std::make_unique<SimAnneal>(_matrix, _size, _random_engine());
+    _fallback->set_parameters(_parameters);
+    _fallback->warm_start({_best_solution});
+}
+
+auto MultiSpinAnneal::_solve_fallback(unsigned time_limit) -> void
+{
+    this->_start_fallback();
+    if (_has_target)
+    {
+        _fallback->set_target(_target);
+    }
+    // the callback, the migrants and the checkpoints of this solver pass through to SA
+    _fallback->set_iteration_callback([this](std::vector<bool> const &best_solution, double best_value)
+                                      {
+        if (_iteration_callback)
+        {
+            _iteration_callback(best_solution, best_value);
+        }
+        for (auto const &[value, solution] : _migrants)
+        {
+            _fallback->immigrate(solution, value);
+        }
+        _migrants.clear();
+        if (this->_checkpoint_if_due())
+        {
+            _fallback->set_target(-std::numeric_limits<double>::infinity());
+        } });
+    _fallback->solve(time_limit);
+    _fallback->set_iteration_callback(nullptr);
+}
+
+auto MultiSpinAnneal::solve(unsigned time_limit) -> void
+{
+    if (_scale == 0)
+    {
+        this->_solve_fallback(time_limit);
+        return;
+    }
+    auto start_time = std::chrono::steady_clock::now();
+    if (!_initialized)
+    {
+        this->warm_start({});
+    }
+    unsigned iteration_count = 0;
+    while (_run_count < _parameters.run_count)
+    {
+        auto start_time_inside = std::chrono::steady_clock::now();
+        this->_adopt_migrants();
+
+        // anneal all chains until none of them made an improving flip for anneal_count sweeps
+        std::vector<std::int64_t> values;
+        double temperature = _temperature;
+        unsigned unimproved = 0;
+        while (unimproved < _parameters.anneal_count)
+        {
+            unimproved++;
+            if (this->_sweep(temperature))
+            {
+                unimproved = 0;
+            }
+            values = this->_values();
+            this->_update_best(values);
+            temperature *= _parameters.cooling_factor;
+            if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() >= time_limit)
+            {
+                break;
+            }
+        }
+        _temperature *= _parameters.restart_factor;
+        ++iteration_count;
+        ++_run_count;
+        GUMMY_COUNT(_statistics, restarts, 1);
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        {
+            GUMMY_PHASE(_statistics, Phase::logging);
+            _output += "Iteration: ";
+            _output += std::to_string(_run_count);
+            _output += ";Local Best: ";
+            _output += std::to_string(double(*std::max_element(values.begin(), values.end())) / _scale);
+            _output += ";Current Best: ";
+            _output += std::to_string(_best_value);
+            _output += ";time: ";
+            _output += std::to_string(std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_inside).count());
+            _output += "\n";
+        }
+
+        if (this->_end_of_iteration(_best_solution, _best_value))
+        {
+            break;
+        }
+        if (seconds + seconds / iteration_count >= time_limit)
+        {
+            break;
+        }
+    }
+}
+
+auto MultiSpinAnneal::get_solution() -> std::vector<bool>
+{
+    return _fallback ? _fallback->get_solution() : _best_solution;
+}
+
+auto MultiSpinAnneal::get_output() -> std::string
+{
+    return _fallback ? _output + _fallback->get_output() : _output;
+}
+
+auto MultiSpinAnneal::update_instance(std::vector<QuboEdit> const &changes) -> void
+{
+    if (_fallback)
+    {
+        _fallback->update_instance(changes);
+        return;
+    }
+    for (auto const &change : changes)
+    {
+        _sparse.add(change.row, change.column, change.value);
+        _best_value += change.value * _best_solution[change.row] * _best_solution[change.column];
+    }
+    if (integer_scale(_sparse) == 0)
+    {
+        // the chains cannot hold the edited objective, SA continues from the best chain at the next solve,
+        // when the solver matrix (and any replica of it) carries the edits
+        std::cout << "The edited instance is not integer after scaling, MSA continues as SA" << std::endl;
+        _scale = 0;
+        return;
+    }
+    this->_build();
+}
+
+auto MultiSpinAnneal::save_checkpoint(std::ostream &stream) -> void
+{
+    if (_fallback)
+    {
+        _fallback->save_checkpoint(stream);
+        return;
+    }
+    write_header(stream, "MSA", _size);
+    write_random_engine(stream, _random_engine);
+    for (std::uint64_t word : _chains)
+    {
+        write_value<std::uint64_t>(stream, word);
+    }
+    write_solution(stream, _best_solution);
+    write_value<double>(stream, _best_value);
+    write_value<double>(stream, _temperature);
+    write_value<unsigned>(stream, _run_count);
+}
+
+auto MultiSpinAnneal::load_checkpoint(std::istream &stream) -> bool
+{
+    if (_fallback)
+    {
+        return _fallback->load_checkpoint(stream);
+    }
+    if (!read_header(stream, "MSA", _size))
+    {
+        return false;
+    }
+    read_random_engine(stream, _random_engine);
+    for (auto &word : _chains)
+    {
+        word = read_value<std::uint64_t>(stream);
+    }
+    _best_solution = read_solution(stream, _size);
+    _best_value = read_value<double>(stream);
+    _temperature = read_value<double>(stream);
+    _run_count = read_value<unsigned>(stream);
+    _initialized = true;
+    return bool(stream);
+}
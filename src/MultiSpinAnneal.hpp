@@ -0,0 +1,109 @@
+/**
+ * @file MultiSpinAnneal.hpp
+ * @author Gennesaret Tjusila
+ * @brief Simulated annealing of 64 chains at once, one chain per bit of a word
+ */
+#ifndef MultiSpinAnneal_H
+#define MultiSpinAnneal_H
+#include "Heuristic.hpp"
+#include "Matrix.hpp"
+#include "SimAnneal.hpp"
+#include "SparseMatrix.hpp"
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/// @brief Multi-spin coded annealer for integer coefficients
+///
+/// Variable i is one 64-bit word whose bit c is x_i in chain c. A visit of i sums the neighbour
+/// words into a bit-sliced counter, one word per bit of the counter, and decides the flips of all
+/// 64 chains with a few word compares against the gain thresholds of the current temperature.
+/// Every chain draws its own uniform, so chains that meet do not stay together. The schedule
+/// of SAParameters applies to all chains, a run ends once no chain made an improving flip for
+/// anneal_count sweeps. The chain values are evaluated bit-sliced after every sweep, the best
+/// one is kept. An edit that leaves no integer scale hands the search over to SimAnneal.
+class MultiSpinAnneal : public Heuristic
+{
+public:
+    /// @param matrix Q matrix with coefficients that are integers after scaling by integer_scale
+    /// @param size Problem size
+    /// @param seed RNG seed
+    MultiSpinAnneal(Matrix const &matrix, unsigned size, unsigned seed);
+    /// @brief Smallest power of two up to 1024 that makes all coefficients integer
+    /// @return 0 if there is none or the objective range does not fit the bit-sliced counters
+    static unsigned integer_scale(SparseMatrix const &sparse);
+    void solve(unsigned time_limit) override;
+    /// @brief Best solution of all chains
+    std::vector<bool> get_solution() override;
+    std::string get_output() override;
+    /// @brief Start every chain from one of the supplied solutions, the remaining chains randomly
+    void warm_start(std::vector<std::vector<bool>> const &solutions) override;
+    /// @brief Rebuild the integer coefficients, the chains keep their states
+    ///
+    /// If the edited coefficients have no integer scale, the following solves run SimAnneal
+    /// from the best chain instead.
+    void update_instance(std::vector<QuboEdit> const &changes) override;
+    void save_checkpoint(std::ostream &stream) override;
+    bool load_checkpoint(std::istream &stream) override;
+    /// @brief Replace the schedule constants, call before the first solve
+    void set_parameters(SAParameters const &parameters);
+
+private:
+    Matrix const &_matrix;
+    std::string _output;
+    unsigned _size;
+    SAParameters _parameters;
+    /// @brief Start temperature of the next annealing run
+    double _temperature;
+    /// @brief Completed annealing runs
+    unsigned _run_count;
+    bool _initialized;
+    SparseMatrix _sparse;
+    /// @brief Coefficient scale, the chains see scale * Q. 0 once an edit left no integer scale
+    unsigned _scale;
+    /// @brief Scaled diagonal, neighbours and neighbour coefficients in CSR form
+    std::vector<std::int64_t> _diagonal;
+    std::vector<unsigned> _neighbour_start;
+    std::vector<unsigned> _neighbour;
+    std::vector<std::int64_t> _weight;
+    /// @brief Bits of the counter of a visit per variable, and of the objective counter
+    std::vector<unsigned> _field_bits;
+    unsigned _value_bits;
+    /// @brief Sum of the negative scaled neighbour coefficients per variable, and of all negative coefficients
+    std::vector<std::int64_t> _negative_sum;
+    std::int64_t _negative_total;
+    /// @brief Largest absolute scaled gain of a flip
+    std::int64_t _max_gain;
+    /// @brief Chain states, one word per variable
+    std::vector<std::uint64_t> _chains;
+    std::vector<bool> _best_solution;
+    double _best_value;
+    std::mt19937 _random_engine;
+    /// @brief Fixed point acceptance probability of a gain of -d at the current temperature
+    std::vector<std::uint64_t> _acceptance;
+    /// @brief Takes over once the instance has no integer scale
+    std::unique_ptr<SimAnneal> _fallback;
+    /// @brief Create the fallback from the best chain
+    auto _start_fallback() -> void;
+    /// @brief Solve with the fallback, passing the callback, migrants, target and checkpoints through
+    auto _solve_fallback(unsigned time_limit) -> void;
+    /// @brief Convert the patched neighbour lists to scaled integers
+    auto _build() -> void;
+    /// @brief One sweep over all variables at a temperature
+    /// @return True if any chain made an improving flip
+    auto _sweep(double temperature) -> bool;
+    /// @brief Scaled objective values of all chains
+    auto _values() const -> std::vector<std::int64_t>;
+    /// @brief Take over the best chain if it beats the incumbent
+    /// @param values Scaled chain values of _values
+    auto _update_best(std::vector<std::int64_t> const &values) -> void;
+    /// @brief Write a solution into a chain
+    auto _set_chain(unsigned chain, std::vector<bool> const &solution) -> void;
+    /// @brief Replace the worst chains by better migrants
+    auto _adopt_migrants() -> void;
+    auto _random_word() -> std::uint64_t;
+};
+#endif
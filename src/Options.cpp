@@ -0,0 +1,349 @@
+#include "Options.hpp"
+#include "SolverConfiguration.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /// @brief Parse a number, the whole string has to be consumed
+    template <typename T>
+    bool parse(std::string const &text, T &value)
+    {
+        std::istringstream stream(text);
+        T parsed;
+        if (!(stream >> parsed) || !stream.eof())
+        {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    auto trim(std::string const &text) -> std::string
+    {
+        auto first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos)
+        {
+            return "";
+        }
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+
+    /// @brief Queue a solver parameter after checking it on a scratch configuration
+    auto add_parameter(RunOptions &options, std::string const &name, std::string const &value) -> bool
+    {
+        SolverConfiguration scratch;
+        if (!set_parameter(scratch, name, value))
+        {
+            return false;
+        }
+        options.parameters.emplace_back(name, value);
+        return true;
+    }
+
+    /// @brief Set one named option
+    auto apply_option(RunOptions &options, std::string const &name, std::string const &value, std::string &error) -> bool
+    {
+        bool valid = true;
+        if (name == "instance")
+        {
+            options.instance = value;
+        }
+        else if (name == "reference")
+        {
+            options.reference = value;
+        }
+        else if (name == "solver")
+        {
+            options.solver = value;
+        }
+        else if (name == "time")
+        {
+            valid = parse(value, options.time_limit);
+        }
+        else if (name == "target")
+        {
+            valid = options.has_target = parse(value, options.target);
+        }
+        else if (name == "seed")
+        {
+            valid = options.has_seed = parse(value, options.seed);
+        }
+        else if (name == "threads")
+        {
+            valid = parse(value, options.threads);
+        }
+        else if (name == "parallel")
+        {
+            valid = parse(value, options.parallel);
+        }
+        else if (name == "numa")
+        {
+            valid = value == "on" || value == "off";
+            options.numa = value == "on";
+        }
+        else if (name == "huge-pages")
+        {
+            valid = value == "on" || value == "off";
+            options.huge_pages = value == "on";
+        }
+        else if (name == "reorder")
+        {
+            valid = value == "none" || value == "rcm";
+            options.reorder = value;
+        }
+        else if (name == "memory-limit")
+        {
+            valid = parse(value, options.memory_limit);
+        }
+        else if (name == "solution")
+        {
+            options.solution_path = value;
+        }
+        else if (name == "log")
+        {
+            options.log_path = value;
+        }
+        else if (name == "checkpoint")
+        {
+            options.checkpoint_path = value;
+        }
+        else if (name == "checkpoint-interval")
+        {
+            valid = parse(value, options.checkpoint_interval);
+        }
+        else if (name == "resume")
+        {
+            options.resume_path = value;
+        }
+        else if (name == "edits")
+        {
+            options.edits_path = value;
+        }
+        else if (name == "verify")
+        {
+            options.verify_paths.push_back(value);
+        }
+        else if (name == "warm-start")
+        {
+            options.warm_start_paths.push_back(value);
+        }
+        else if (name == "config")
+        {
+            options.configuration_path = value;
+        }
+        else if (name == "rules")
+        {
+            options.rules_path = value;
+        }
+        else if (name == "options")
+        {
+            return read_option_file(value, options, error);
+        }
+        else if (name == "tune")
+        {
+            options.tune_directory = value;
+        }
+        else if (name == "candidates")
+        {
+            valid = parse(value, options.tune_configurations) && options.tune_configurations > 0;
+        }
+        else if (name == "island")
+        {
+            options.island_address = value;
+        }
+        else if (name == "peer")
+        {
+            options.island_peers.push_back(value);
+        }
+        else if (name == "island-interval")
+        {
+            valid = parse(value, options.island_interval) && options.island_interval > 0;
+        }
+        else if (name == "batch")
+        {
+            options.batch_directory = value;
+        }
+        else if (name == "references")
+        {
+            options.reference_directory = value;
+        }
+        else if (name == "serve")
+        {
+            options.serve_address = value;
+        }
+        else if (name == "queue")
+        {
+            valid = parse(value, options.queue_limit);
+        }
+        else if (name == "cache")
+        {
+            valid = parse(value, options.cache_size) && options.cache_size > 0;
+        }
+        else if (name == "instance-root")
+        {
+            options.instance_root = value;
+        }
+        else if (name == "tabu")
+        {
+            valid = (value == "adaptive" || value == "fixed") && add_parameter(options, "tabu.adaptive", value == "adaptive" ? "1" : "0");
+        }
+        else if (name == "tabu-cutoff")
+        {
+            valid = add_parameter(options, "tabu.cutoff", value);
+        }
+        else
+        {
+            auto names = parameter_names();
+            if (std::find(names.begin(), names.end(), name) == names.end())
+            {
+                error = "unknown option " + name;
+                return false;
+            }
+            valid = add_parameter(options, name, value);
+        }
+        if (!valid)
+        {
+            error = "invalid value " + value + " for " + name;
+        }
+        return valid;
+    }
+}
+
+auto parse_options(int argc, char const *argv[], RunOptions &options, std::string &error) -> bool
+{
+    char const *positional[] = {"instance", "reference", "solver", "time"};
+    unsigned positional_count = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--help" || argument == "-h")
+        {
+            options.help = true;
+            continue;
+        }
+        if (argument.compare(0, 2, "--") != 0)
+        {
+            if (positional_count == sizeof(positional) / sizeof(positional[0]))
+            {
+                error = "unexpected argument " + argument;
+                return false;
+            }
+            if (!apply_option(options, positional[positional_count++], argument, error))
+            {
+                return false;
+            }
+            continue;
+        }
+        std::string name = argument.substr(2);
+        std::string value;
+        auto separator = name.find('=');
+        if (separator != std::string::npos)
+        {
+            value = name.substr(separator + 1);
+            name = name.substr(0, separator);
+        }
+        else if (i + 1 < argc)
+        {
+            value = argv[++i];
+        }
+        else
+        {
+            error = "missing value for --" + name;
+            return false;
+        }
+        if (!apply_option(options, name, value, error))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto read_option_file(std::string const &path, RunOptions &options, std::string &error) -> bool
+{
+    std::ifstream input_file(path);
+    if (!input_file)
+    {
+        error = "cannot read option file " + path;
+        return false;
+    }
+    std::string line;
+    unsigned line_number = 0;
+    while (std::getline(input_file, line))
+    {
+        line_number++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+        {
+            continue;
+        }
+        auto separator = line.find('=');
+        if (separator == std::string::npos)
+        {
+            error = path + ":" + std::to_string(line_number) + ": expected name = value";
+            return false;
+        }
+        if (!apply_option(options, trim(line.substr(0, separator)), trim(line.substr(separator + 1)), error))
+        {
+            error = path + ":" + std::to_string(line_number) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+auto usage() -> std::string
+{
+    std::string text =
+        "Usage: gummy {instance} [{reference}] [{solver}] [{time}] [options]\n"
+        "       gummy --batch {directory} [--references {directory}] [--solution {directory}] [--log {directory}] [options]\n"
+        "       gummy --serve {address} [--threads n] [--queue n] [--cache n] [--time s] [--config file] [--rules file]\n"
+        "                      [--memory-limit MiB] [--instance-root {directory}]\n"
+        "       gummy --tune {directory} --solver {solver} --config {file} [--time s] [--threads n] [--candidates n]\n"
+        "\n"
+        "  --instance {file}            QPLIB .qs instance\n"
+        "  --reference {file}           QPLIB solution to compare against\n"
+        "  --solver {solver}            DTSS, MSTS, SA, MSA or AUTO, default DTSS\n"
+        "  --time {seconds}             Time limit per solve, default 600\n"
+        "  --target {value}             Stop once the objective reaches value\n"
+        "  --seed {seed}                Solver seed\n"
+        "  --threads {n}                Threads of the tuner and workers of the server, default all cores\n"
+        "  --parallel {n}               Solve with n solver threads sharing an incumbent, 0 uses all cores\n"
+        "  --numa {off|on}              Pin parallel threads to NUMA nodes with a copy of Q per node, default off\n"
+        "  --huge-pages {off|on}        Back large instance arrays with transparent huge pages, default off\n"
+        "  --reorder {none|rcm}         Solve in reverse Cuthill-McKee variable order, default none\n"
+        "  --memory-limit {MiB}         Pick a matrix storage that fits, fail fast if none does,\n"
+        "                               the server refuses larger instances, default 1024 there\n"
+        "  --solution {file}            Write the best solution in QPLIB solution format\n"
+        "  --log {file}                 Write the iteration log to file\n"
+        "  --checkpoint {file}          Checkpoint on SIGUSR1/SIGTERM\n"
+        "  --checkpoint-interval {s}    Also checkpoint every s seconds\n"
+        "  --resume {file}              Continue from a checkpoint\n"
+        "  --edits {file}               Re-solve after applying coefficient edits\n"
+        "  --verify {file}              Evaluate a solution file (repeatable)\n"
+        "  --warm-start {file}          Start from a solution file (repeatable)\n"
+        "  --config {file}              Tuned parameters per instance class\n"
+        "  --rules {file}               Solver selection rules of AUTO\n"
+        "  --options {file}             Read options from a file, one name = value per line\n"
+        "  --island {address}           Exchange solutions, address is a socket path or host:port\n"
+        "  --peer {address}             Address of another island (repeatable)\n"
+        "  --island-interval {s}        Seconds between exchanges, default 5\n"
+        "  --batch {directory}          Solve every .qs instance of a directory\n"
+        "  --references {directory}     {instance}_answer.qs reference solutions of a batch\n"
+        "  --serve {address}            Serve solve requests on a socket path or host:port\n"
+        "  --queue {n}                  Requests waiting for a server worker, more are refused, default 16\n"
+        "  --cache {n}                  Instances the server keeps parsed, default 8\n"
+        "  --instance-root {directory}  Directory server requests may read instances from, default working directory\n"
+        "  --tabu {fixed|adaptive}      Tabu policy of DTSS and MSTS\n"
+        "  --tabu-cutoff {iterations}   Tabu search improvement cutoff\n"
+        "  --{parameter} {value}        Solver parameter:";
+    for (auto const &name : parameter_names())
+    {
+        text += " " + name;
+    }
+    return text + "\n";
+}
@@ -0,0 +1,92 @@
+/**
+ * @file Options.hpp
+ * @author Gennesaret Tjusila
+ * @brief Command line and option file settings of a gummy run
+ */
+#ifndef Options_H
+#define Options_H
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Everything a gummy run can be configured with
+struct RunOptions
+{
+    std::string instance;
+    /// @brief QPLIB solution file to compare against, optional
+    std::string reference;
+    std::string solver = "DTSS";
+    /// @brief Time limit in seconds per solve, 0 uses 600 for a solve and 1 for a tuning round
+    unsigned time_limit = 0;
+    /// @brief Stop once this objective value is reached
+    bool has_target = false;
+    double target = 0;
+    /// @brief Solver seed, a random one if not set
+    bool has_seed = false;
+    unsigned seed = 0;
+    /// @brief Threads of the tuner and workers of the server, 0 uses all cores
+    unsigned threads = 0;
+    /// @brief Solver threads sharing an incumbent, 0 uses all cores
+    unsigned parallel = 1;
+    /// @brief Pin parallel solver threads to NUMA nodes and give every node its own copy of Q
+    bool numa = false;
+    /// @brief Back large instance arrays with transparent huge pages
+    bool huge_pages = false;
+    /// @brief Variable order the solver works in, "none" or "rcm"
+    std::string reorder = "none";
+    /// @brief RAM limit in MiB, 0 keeps the dense double matrix without checking
+    unsigned memory_limit = 0;
+    /// @brief Write the best solution in QPLIB solution format, a directory in batch mode
+    std::string solution_path;
+    /// @brief Write the iteration log here instead of to the console, a directory in batch mode
+    std::string log_path;
+    std::string checkpoint_path;
+    unsigned checkpoint_interval = 0;
+    std::string resume_path;
+    std::string edits_path;
+    std::vector<std::string> verify_paths;
+    std::vector<std::string> warm_start_paths;
+    /// @brief Tuned parameters per instance class
+    std::string configuration_path;
+    /// @brief Solver selection rules of the AUTO solver
+    std::string rules_path;
+    /// @brief Solver parameters given by name, applied after the tuned ones
+    std::vector<std::pair<std::string, std::string>> parameters;
+    /// @brief Tune on the instances of this directory instead of solving
+    std::string tune_directory;
+    /// @brief Own island address, a socket path or host:port, empty runs without islands
+    std::string island_address;
+    std::vector<std::string> island_peers;
+    /// @brief Seconds between island exchanges
+    unsigned island_interval = 5;
+    unsigned tune_configurations = 16;
+    /// @brief Solve every instance of this directory
+    std::string batch_directory;
+    /// @brief Directory of {instance}_answer.qs reference solutions of a batch
+    std::string reference_directory;
+    /// @brief Serve solve requests on this address instead of solving
+    std::string serve_address;
+    /// @brief Requests the server lets wait for a worker
+    unsigned queue_limit = 16;
+    /// @brief Instances the server keeps parsed
+    unsigned cache_size = 8;
+    /// @brief Directory the server's requests may read instances from, the working directory if empty
+    std::string instance_root;
+    bool help = false;
+};
+
+/// @brief Parse the command line
+///
+/// Options are "--name value" or "--name=value". Arguments without a name fill the instance,
+/// reference, solver and time limit in this order, as in the positional form
+/// "gummy {instance} {reference} {solver} {time}".
+/// @param error Receives the reason if parsing failed
+/// @return False on an unknown option, a missing value or a malformed number
+bool parse_options(int argc, char const *argv[], RunOptions &options, std::string &error);
+/// @brief Read an option file, one "name = value" line per option with the names of the command line
+/// @param error Receives the reason if reading failed
+/// @return False if the file is missing or has an invalid line
+bool read_option_file(std::string const &path, RunOptions &options, std::string &error);
+/// @brief Usage text of all options
+std::string usage();
+#endif
@@ -0,0 +1,30 @@
+#include "PairMoves.hpp"
+#include "SparseMatrix.hpp"
+#include <limits>
+#include <vector>
+
+auto best_pair_move(SparseMatrix const &matrix, std::vector<bool> const &solution, std::vector<double> const &gain,
+                    std::vector<double> const &tabu_tenure, unsigned iteration, double aspiration) -> PairMove
+{
+    unsigned size = matrix.size();
+    PairMove best{0, 0, -std::numeric_limits<double>::infinity()};
+    for (unsigned i = 0; i < size; i++)
+    {
+        bool first_tabu = tabu_tenure[i] > iteration;
+        for (auto entry = matrix.begin(i); entry != matrix.end(i); entry++)
+        {
+            unsigned j = entry->column;
+            // every pair is stored in both rows, visit it once
+            if (j >= i)
+            {
+                continue;
+            }
+            double pair_gain = gain[i] + gain[j] + (1 - 2 * solution[i]) * (1 - 2 * solution[j]) * entry->value;
+            if (pair_gain > best.gain && ((!first_tabu && tabu_tenure[j] <= iteration) || pair_gain > aspiration))
+            {
+                best = PairMove{i, j, pair_gain};
+            }
+        }
+    }
+    return best;
+}
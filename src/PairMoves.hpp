@@ -0,0 +1,34 @@
+/**
+ * @file PairMoves.hpp
+ * @author Gennesaret Tjusila
+ * @brief Two-flip moves over the interacting variable pairs of a tabu search
+ */
+#ifndef PairMoves_H
+#define PairMoves_H
+#include "SparseMatrix.hpp"
+#include <vector>
+
+/// @brief Flip of two variables i > j with a nonzero Q(i, j)
+struct PairMove
+{
+    unsigned first;
+    unsigned second;
+    double gain;
+};
+
+/// @brief Best admissible two-flip move in O(nonzero)
+///
+/// The gain of flipping i and j is delta_i + delta_j + (1 - 2x_i)(1 - 2x_j)Q(i, j), with the single
+/// flip gains the scan of the tabu search already computed. Pairs without interaction gain exactly
+/// as much as their two single flips, so only nonzero Q(i, j) are visited. A pair is admissible if
+/// neither variable is tabu or if it leads to a new best solution.
+/// @param matrix Sparse Q matrix
+/// @param solution Current solution
+/// @param gain Single flip gain of every variable, tabu ones included
+/// @param tabu_tenure Iteration until which a variable is tabu
+/// @param iteration Current iteration
+/// @param aspiration Gain that makes a tabu pair admissible, best value minus current value
+/// @return Best pair, first == second if no pair is admissible
+PairMove best_pair_move(SparseMatrix const &matrix, std::vector<bool> const &solution, std::vector<double> const &gain,
+                        std::vector<double> const &tabu_tenure, unsigned iteration, double aspiration);
+#endif
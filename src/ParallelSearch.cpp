@@ -0,0 +1,175 @@
+#include "ParallelSearch.hpp"
+#include "Checkpoint.hpp"
+#include "Heuristic.hpp"
+#include "Placement.hpp"
+#include "SharedSolutions.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+ParallelSearch::ParallelSearch(std::vector<std::unique_ptr<Heuristic>> searches, unsigned size)
+    : _searches(std::move(searches)),
+      _size{size},
+      _incumbent(size),
+      _pool(size, 20, size / 100 + 1),
+      _stop{false},
+      _affinity() {}
+auto ParallelSearch::solve(unsigned time_limit) -> void
+{
+    _stop = false;
+    std::vector<std::thread> threads;
+    for (unsigned k = 0; k < _searches.size(); k++)
+    {
+        if (_has_target)
+        {
+            _searches[k]->set_target(_target);
+        }
+        threads.emplace_back([this, k, time_limit]()
+                             {
+            if (k < _affinity.size())
+            {
+                pin_thread(_affinity[k]);
+            }
+            std::uint64_t seen_version = 0;
+            std::mt19937 random_engine(k);
+            _searches[k]->set_iteration_callback([this, k, &seen_version, &random_engine](std::vector<bool> const &best_solution, double best_value)
+                                                 { this->_exchange(k, best_solution, best_value, seen_version, random_engine); });
+            _searches[k]->solve(time_limit);
+            // a thread done early ends the others, they would only reach the same limits later
+            _stop = true; });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    for (auto &search : _searches)
+    {
+        search->set_iteration_callback(nullptr);
+    }
+}
+auto ParallelSearch::_exchange(unsigned k, std::vector<bool> const &best_solution, double best_value,
+                               std::uint64_t &seen_version, std::mt19937 &random_engine) -> void
+{
+    Heuristic &search = *_searches[k];
+    _incumbent.publish(best_solution, best_value);
+    _pool.insert(best_solution, best_value);
+    if (_incumbent.version() != seen_version)
+    {
+        double value;
+        std::vector<bool> incumbent = _incumbent.get(value);
+        seen_version = _incumbent.version();
+        if (value > best_value)
+        {
+            search.immigrate(incumbent, value);
+        }
+    }
+    else
+    {
+        double value;
+        std::uniform_int_distribution<unsigned> member(0, _pool.capacity() - 1);
+        std::vector<bool> solution = _pool.get(member(random_engine), value);
+        if (value > -std::numeric_limits<double>::infinity())
+        {
+            search.immigrate(solution, value);
+        }
+    }
+    // the outer callback and the outer migrants are served by one thread only
+    if (k == 0)
+    {
+        double value;
+        std::vector<bool> incumbent = _incumbent.get(value);
+        if (_iteration_callback)
+        {
+            _iteration_callback(incumbent, value);
+        }
+        for (auto const &[migrant_value, migrant] : _migrants)
+        {
+            search.immigrate(migrant, migrant_value);
+        }
+        _migrants.clear();
+    }
+    if (_stop)
+    {
+        search.set_target(-std::numeric_limits<double>::infinity());
+    }
+}
+auto ParallelSearch::get_solution() -> std::vector<bool>
+{
+    double value;
+    std::vector<bool> incumbent = _incumbent.get(value);
+    // nothing was published if no thread finished an outer iteration
+    return value > -std::numeric_limits<double>::infinity() ? incumbent : _searches[0]->get_solution();
+}
+auto ParallelSearch::get_output() -> std::string
+{
+    std::string output;
+    for (unsigned k = 0; k < _searches.size(); k++)
+    {
+        output += "Thread " + std::to_string(k) + "\n" + _searches[k]->get_output();
+    }
+    return output;
+}
+auto ParallelSearch::warm_start(std::vector<std::vector<bool>> const &solutions) -> void
+{
+    for (auto &search : _searches)
+    {
+        search->warm_start(solutions);
+    }
+}
+auto ParallelSearch::update_instance(std::vector<QuboEdit> const &changes) -> void
+{
+    for (auto &search : _searches)
+    {
+        search->update_instance(changes);
+    }
+    // the stored values belong to the old instance, the threads publish again
+    _incumbent.clear();
+    _pool.clear();
+}
+auto ParallelSearch::save_checkpoint(std::ostream &stream) -> void
+{
+    write_header(stream, "PARALLEL", _size);
+    write_value<unsigned>(stream, _searches.size());
+    for (auto &search : _searches)
+    {
+        search->save_checkpoint(stream);
+    }
+}
+auto ParallelSearch::load_checkpoint(std::istream &stream) -> bool
+{
+    if (!read_header(stream, "PARALLEL", _size) || read_value<unsigned>(stream) != _searches.size())
+    {
+        return false;
+    }
+    for (auto &search : _searches)
+    {
+        if (!search->load_checkpoint(stream))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+auto ParallelSearch::set_affinity(std::vector<std::vector<unsigned>> cpus) -> void
+{
+    _affinity = std::move(cpus);
+}
+auto ParallelSearch::get_statistics() const -> std::string
+{
+    std::string statistics;
+    for (unsigned k = 0; k < _searches.size(); k++)
+    {
+        std::string thread_statistics = _searches[k]->get_statistics();
+        if (!thread_statistics.empty())
+        {
+            statistics += "Thread " + std::to_string(k) + "\n" + thread_statistics;
+        }
+    }
+    return statistics;
+}
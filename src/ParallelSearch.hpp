@@ -0,0 +1,58 @@
+/**
+ * @file ParallelSearch.hpp
+ * @author Gennesaret Tjusila
+ * @brief Several solvers on threads sharing an incumbent and an elite pool
+ */
+#ifndef ParallelSearch_H
+#define ParallelSearch_H
+#include "Heuristic.hpp"
+#include "SharedSolutions.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/// @brief Runs one solver per thread on the same instance
+///
+/// After every outer iteration a solver publishes its best solution to a SharedIncumbent and a
+/// SharedElitePool. It immigrates the incumbent when another thread found a better one, and one
+/// random pool member otherwise, which DTSS takes into its elite set. The first thread also
+/// serves the iteration callback and the migrants of this heuristic.
+class ParallelSearch : public Heuristic
+{
+public:
+    /// @brief Create a parallel search
+    /// @param searches Solvers, one thread each, seeded differently
+    /// @param size Problem size
+    ParallelSearch(std::vector<std::unique_ptr<Heuristic>> searches, unsigned size);
+    /// @brief Solve on all threads until the time limit, a stop signal or the target
+    void solve(unsigned time_limit) override;
+    /// @brief Get the incumbent
+    std::vector<bool> get_solution() override;
+    /// @brief Iteration data of every thread
+    std::string get_output() override;
+    void warm_start(std::vector<std::vector<bool>> const &solutions) override;
+    void update_instance(std::vector<QuboEdit> const &changes) override;
+    /// @brief Write the checkpoints of all solvers one after another
+    void save_checkpoint(std::ostream &stream) override;
+    bool load_checkpoint(std::istream &stream) override;
+    /// @brief Counters of every thread
+    std::string get_statistics() const override;
+    /// @brief Pin thread k to the CPUs cpus[k] while it solves
+    void set_affinity(std::vector<std::vector<unsigned>> cpus);
+
+private:
+    std::vector<std::unique_ptr<Heuristic>> _searches;
+    unsigned _size;
+    SharedIncumbent _incumbent;
+    SharedElitePool _pool;
+    std::atomic<bool> _stop;
+    std::vector<std::vector<unsigned>> _affinity;
+    /// @brief Called by thread k after each of its outer iterations
+    void _exchange(unsigned k, std::vector<bool> const &best_solution, double best_value,
+                   std::uint64_t &seen_version, std::mt19937 &random_engine);
+};
+#endif
@@ -0,0 +1,138 @@
+#include "Placement.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::atomic<bool> huge_pages{false};
+}
+
+auto parse_cpu_list(std::string const &text) -> std::vector<unsigned>
+{
+    std::vector<unsigned> cpus;
+    std::istringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        unsigned first;
+        unsigned last;
+        char dash;
+        std::istringstream bounds(range);
+        if (!(bounds >> first))
+        {
+            continue;
+        }
+        last = (bounds >> dash >> last) && dash == '-' ? last : first;
+        for (unsigned cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+auto numa_nodes() -> std::vector<NumaNode>
+{
+    namespace fs = std::filesystem;
+    std::vector<NumaNode> nodes;
+    std::error_code error;
+    for (fs::directory_iterator entry("/sys/devices/system/node", error), end; !error && entry != end; entry.increment(error))
+    {
+        std::string name = entry->path().filename().string();
+        if (name.compare(0, 4, "node") != 0 || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), ::isdigit))
+        {
+            continue;
+        }
+        std::ifstream cpulist(entry->path() / "cpulist");
+        std::string text;
+        std::getline(cpulist, text);
+        NumaNode node{unsigned(std::stoul(name.substr(4))), parse_cpu_list(text)};
+        // memory-only nodes cannot run a solver thread
+        if (!node.cpus.empty())
+        {
+            nodes.push_back(node);
+        }
+    }
+    if (nodes.empty())
+    {
+        NumaNode node{0, {}};
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++)
+        {
+            node.cpus.push_back(cpu);
+        }
+        nodes.push_back(node);
+    }
+    std::sort(nodes.begin(), nodes.end(), [](NumaNode const &a, NumaNode const &b)
+              { return a.id < b.id; });
+    return nodes;
+}
+
+auto pin_thread(std::vector<unsigned> const &cpus) -> bool
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : cpus)
+    {
+        if (cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+auto run_on_cpus(std::vector<unsigned> const &cpus, std::function<void()> const &task) -> void
+{
+    std::thread thread([&cpus, &task]()
+                       {
+        pin_thread(cpus);
+        task(); });
+    thread.join();
+}
+
+auto set_huge_pages(bool enabled) -> void
+{
+    huge_pages = enabled;
+}
+
+auto allocate_block(std::size_t bytes) -> void *
+{
+    if (bytes < huge_page_bytes)
+    {
+        return ::operator new(bytes);
+    }
+    // aligned and rounded up so the kernel can map the block with whole huge pages
+    std::size_t rounded = (bytes + huge_page_bytes - 1) / huge_page_bytes * huge_page_bytes;
+    void *block = std::aligned_alloc(huge_page_bytes, rounded);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    if (huge_pages)
+    {
+        madvise(block, rounded, MADV_HUGEPAGE);
+    }
+    return block;
+}
+
+auto free_block(void *block, std::size_t bytes) -> void
+{
+    if (bytes < huge_page_bytes)
+    {
+        ::operator delete(block);
+        return;
+    }
+    std::free(block);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file Placement.hpp
+ * @author Gennesaret Tjusila
+ * @brief NUMA topology, thread pinning and huge page backed allocation
+ */
+#ifndef Placement_H
+#define Placement_H
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+/// @brief A NUMA node and the CPUs attached to it
+struct NumaNode
+{
+    unsigned id;
+    std::vector<unsigned> cpus;
+};
+
+/// @brief Parse a kernel CPU list such as "0-3,8-11"
+std::vector<unsigned> parse_cpu_list(std::string const &text);
+/// @brief NUMA nodes with CPUs from /sys/devices/system/node
+/// @return One node with all CPUs if the machine does not report any
+std::vector<NumaNode> numa_nodes();
+/// @brief Restrict the calling thread to some CPUs
+/// @return False if the kernel refused, the thread then runs anywhere
+bool pin_thread(std::vector<unsigned> const &cpus);
+/// @brief Run a task on a thread pinned to some CPUs and wait for it
+///
+/// Memory the task touches first is placed on the node of these CPUs by the kernel's first
+/// touch policy, so replicas and solver state built by the task live next to their threads.
+void run_on_cpus(std::vector<unsigned> const &cpus, std::function<void()> const &task);
+
+/// @brief Ask for transparent huge pages on the large blocks of HugePageAllocator
+void set_huge_pages(bool enabled);
+/// @brief Allocate a block, blocks of at least huge_page_bytes are aligned to a huge page
+void *allocate_block(std::size_t bytes);
+/// @brief Free a block of allocate_block, bytes has to be the allocated size
+void free_block(void *block, std::size_t bytes);
+/// @brief Size of a transparent huge page on x86-64 and arm64 with 4 KiB base pages
+constexpr std::size_t huge_page_bytes = std::size_t(2) << 20;
+
+/// @brief Standard allocator that backs blocks of 2 MiB and more with huge pages after set_huge_pages
+///
+/// Large arrays of the instance, such as the float triangle and the neighbour lists, then need
+/// far fewer TLB entries. Small blocks go to operator new as usual.
+template <typename T>
+struct HugePageAllocator
+{
+    using value_type = T;
+    HugePageAllocator() = default;
+    template <typename U>
+    HugePageAllocator(HugePageAllocator<U> const &) {}
+    T *allocate(std::size_t count)
+    {
+        return static_cast<T *>(allocate_block(count * sizeof(T)));
+    }
+    void deallocate(T *block, std::size_t count)
+    {
+        free_block(block, count * sizeof(T));
+    }
+    template <typename U>
+    bool operator==(HugePageAllocator<U> const &) const
+    {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(HugePageAllocator<U> const &) const
+    {
+        return false;
+    }
+};
+#endif
@@ -0,0 +1,197 @@
+#include "Reordering.hpp"
+#include "Checkpoint.hpp"
+#include "Heuristic.hpp"
+#include "Matrix.hpp"
+#include "SparseMatrix.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+auto reverse_cuthill_mckee(SparseMatrix const &sparse) -> std::vector<unsigned>
+{
+    unsigned size = sparse.size();
+    auto degree = [&sparse](unsigned i)
+    {
+        return unsigned(sparse.end(i) - sparse.begin(i));
+    };
+    // component roots in order of increasing degree, ties by index so the order is reproducible
+    std::vector<unsigned> roots(size);
+    std::iota(roots.begin(), roots.end(), 0);
+    std::stable_sort(roots.begin(), roots.end(), [&degree](unsigned a, unsigned b)
+                     { return degree(a) < degree(b); });
+
+    std::vector<unsigned> order;
+    order.reserve(size);
+    std::vector<bool> visited(size, false);
+    std::vector<unsigned> neighbours;
+    for (unsigned root : roots)
+    {
+        if (visited[root])
+        {
+            continue;
+        }
+        visited[root] = true;
+        // the order doubles as the breadth first queue
+        std::size_t head = order.size();
+        order.push_back(root);
+        for (; head < order.size(); head++)
+        {
+            unsigned vertex = order[head];
+            neighbours.clear();
+            for (auto entry = sparse.begin(vertex); entry != sparse.end(vertex); ++entry)
+            {
+                if (!visited[entry->column])
+                {
+                    visited[entry->column] = true;
+                    neighbours.push_back(entry->column);
+                }
+            }
+            std::stable_sort(neighbours.begin(), neighbours.end(), [&degree](unsigned a, unsigned b)
+                             { return degree(a) < degree(b); });
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+auto bandwidth(SparseMatrix const &sparse, std::vector<unsigned> const &order) -> unsigned
+{
+    std::vector<unsigned> position(order.size());
+    for (unsigned index = 0; index < order.size(); index++)
+    {
+        position[order[index]] = index;
+    }
+    unsigned width = 0;
+    for (unsigned i = 0; i < sparse.size(); i++)
+    {
+        for (auto entry = sparse.begin(i); entry != sparse.end(i); ++entry)
+        {
+            width = std::max(width, unsigned(std::abs(int(position[i]) - int(position[entry->column]))));
+        }
+    }
+    return width;
+}
+
+auto permute_matrix(Matrix const &matrix, std::vector<unsigned> const &order) -> Matrix
+{
+    std::vector<unsigned> position(order.size());
+    for (unsigned index = 0; index < order.size(); index++)
+    {
+        position[order[index]] = index;
+    }
+    Matrix permuted(matrix.size(), matrix.storage());
+    for (unsigned row = 0; row < matrix.size(); row++)
+    {
+        permuted.set(position[row], position[row], matrix(row, row));
+        matrix.for_each_lower(row, [&](unsigned column, double value)
+                              { permuted.set(std::max(position[row], position[column]), std::min(position[row], position[column]), value); });
+    }
+    return permuted;
+}
+
+PermutedHeuristic::PermutedHeuristic(std::unique_ptr<Heuristic> search, std::shared_ptr<Matrix> matrix, std::vector<unsigned> order)
+    : _search(std::move(search)),
+      _matrix(std::move(matrix)),
+      _order(std::move(order)),
+      _position(_order.size())
+{
+    for (unsigned index = 0; index < _order.size(); index++)
+    {
+        _position[_order[index]] = index;
+    }
+}
+auto PermutedHeuristic::_permute(std::vector<bool> const &solution) const -> std::vector<bool>
+{
+    if (solution.size() != _order.size())
+    {
+        return solution;
+    }
+    std::vector<bool> permuted(solution.size());
+    for (unsigned index = 0; index < _order.size(); index++)
+    {
+        permuted[index] = solution[_order[index]];
+    }
+    return permuted;
+}
+auto PermutedHeuristic::_restore(std::vector<bool> const &solution) const -> std::vector<bool>
+{
+    std::vector<bool> restored(solution.size());
+    for (unsigned index = 0; index < solution.size(); index++)
+    {
+        restored[_order[index]] = solution[index];
+    }
+    return restored;
+}
+auto PermutedHeuristic::solve(unsigned time_limit) -> void
+{
+    if (_has_target)
+    {
+        _search->set_target(_target);
+    }
+    // the outer callback and the outer migrants use the original numbering
+    _search->set_iteration_callback([this](std::vector<bool> const &best_solution, double best_value)
+                                    {
+        if (_iteration_callback)
+        {
+            _iteration_callback(this->_restore(best_solution), best_value);
+        }
+        for (auto const &[value, solution] : _migrants)
+        {
+            _search->immigrate(this->_permute(solution), value);
+        }
+        _migrants.clear();
+        if (this->_checkpoint_if_due())
+        {
+            _search->set_target(-std::numeric_limits<double>::infinity());
+        } });
+    _search->solve(time_limit);
+    _search->set_iteration_callback(nullptr);
+}
+auto PermutedHeuristic::get_solution() -> std::vector<bool>
+{
+    return this->_restore(_search->get_solution());
+}
+auto PermutedHeuristic::get_output() -> std::string
+{
+    return _search->get_output();
+}
+auto PermutedHeuristic::warm_start(std::vector<std::vector<bool>> const &solutions) -> void
+{
+    std::vector<std::vector<bool>> permuted;
+    for (auto const &solution : solutions)
+    {
+        permuted.push_back(this->_permute(solution));
+    }
+    _search->warm_start(permuted);
+}
+auto PermutedHeuristic::update_instance(std::vector<QuboEdit> const &changes) -> void
+{
+    std::vector<QuboEdit> permuted;
+    for (auto const &change : changes)
+    {
+        unsigned row = std::max(_position[change.row], _position[change.column]);
+        unsigned column = std::min(_position[change.row], _position[change.column]);
+        _matrix->set(row, column, (*_matrix)(row, column) + change.value);
+        permuted.push_back(QuboEdit{row, column, change.value});
+    }
+    _search->update_instance(permuted);
+}
+auto PermutedHeuristic::save_checkpoint(std::ostream &stream) -> void
+{
+    write_header(stream, "RCM", _order.size());
+    _search->save_checkpoint(stream);
+}
+auto PermutedHeuristic::load_checkpoint(std::istream &stream) -> bool
+{
+    return read_header(stream, "RCM", _order.size()) && _search->load_checkpoint(stream);
+}
+auto PermutedHeuristic::get_statistics() const -> std::string
+{
+    return _search->get_statistics();
+}
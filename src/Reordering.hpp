@@ -0,0 +1,69 @@
+/**
+ * @file Reordering.hpp
+ * @author Gennesaret Tjusila
+ * @brief Bandwidth reducing variable orders and a solver that runs on the reordered instance
+ */
+#ifndef Reordering_H
+#define Reordering_H
+#include "Heuristic.hpp"
+#include "Matrix.hpp"
+#include "SparseMatrix.hpp"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// @brief Reverse Cuthill-McKee order of the interaction graph
+///
+/// Every connected component is traversed breadth first from a vertex of minimum degree, with
+/// the neighbours of a vertex queued by increasing degree, and the whole order is reversed.
+/// Neighbours end up at nearby indices, so the row and gain updates of a flip touch few cache lines.
+/// @param sparse Neighbour lists of the instance
+/// @return order[new index] = old index
+std::vector<unsigned> reverse_cuthill_mckee(SparseMatrix const &sparse);
+
+/// @brief Largest index distance between two interacting variables under an order
+/// @param order order[new index] = old index
+unsigned bandwidth(SparseMatrix const &sparse, std::vector<unsigned> const &order);
+
+/// @brief Copy a Q matrix with renumbered variables, in the same storage
+/// @param matrix Lower triangular Q matrix
+/// @param order order[new index] = old index
+Matrix permute_matrix(Matrix const &matrix, std::vector<unsigned> const &order);
+
+/// @brief Runs a solver on a renumbered copy of the instance
+///
+/// Solutions, warm starts, migrants, instance edits and the iteration callback are translated
+/// between the original numbering outside and the solver's numbering inside, so the wrapper
+/// can stand in for the solver anywhere.
+class PermutedHeuristic : public Heuristic
+{
+public:
+    /// @param search Solver created on the permuted matrix
+    /// @param matrix Permuted matrix, kept alive and edited by the wrapper
+    /// @param order order[new index] = old index
+    PermutedHeuristic(std::unique_ptr<Heuristic> search, std::shared_ptr<Matrix> matrix, std::vector<unsigned> order);
+    void solve(unsigned time_limit) override;
+    /// @brief Best solution of the solver in the original numbering
+    std::vector<bool> get_solution() override;
+    std::string get_output() override;
+    void warm_start(std::vector<std::vector<bool>> const &solutions) override;
+    /// @brief Apply edits of the original matrix to the permuted one and to the solver
+    void update_instance(std::vector<QuboEdit> const &changes) override;
+    /// @brief Write the solver's checkpoint behind a header of its own, so it only resumes reordered
+    void save_checkpoint(std::ostream &stream) override;
+    bool load_checkpoint(std::istream &stream) override;
+    std::string get_statistics() const override;
+
+private:
+    std::unique_ptr<Heuristic> _search;
+    std::shared_ptr<Matrix> _matrix;
+    std::vector<unsigned> _order;
+    /// @brief _position[old index] = new index
+    std::vector<unsigned> _position;
+    /// @brief Solution in the original numbering to the solver's numbering
+    auto _permute(std::vector<bool> const &solution) const -> std::vector<bool>;
+    /// @brief Solution in the solver's numbering to the original numbering
+    auto _restore(std::vector<bool> const &solution) const -> std::vector<bool>;
+};
+#endif
@@ -0,0 +1,438 @@
+#include "Server.hpp"
+#include "Evaluator.hpp"
+#include "Heuristic.hpp"
+#include "Island.hpp"
+#include "Matrix.hpp"
+#include "MemoryPlan.hpp"
+#include "Options.hpp"
+#include "SolverConfiguration.hpp"
+#include "SolverSelection.hpp"
+#include "SparseMatrix.hpp"
+#include "read_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    /// @brief Seconds a client may take to send its request
+    constexpr unsigned request_timeout = 30;
+
+    /// @brief Lets a connected socket be read through std::istream
+    class SocketBuffer : public std::streambuf
+    {
+    public:
+        SocketBuffer(int socket) : _socket{socket}, _buffer(1 << 16) {}
+
+    protected:
+        int_type underflow() override
+        {
+            ssize_t length = recv(_socket, _buffer.data(), _buffer.size(), 0);
+            if (length <= 0)
+            {
+                return traits_type::eof();
+            }
+            setg(_buffer.data(), _buffer.data(), _buffer.data() + length);
+            return traits_type::to_int_type(_buffer[0]);
+        }
+
+    private:
+        int _socket;
+        std::vector<char> _buffer;
+    };
+
+    /// @brief Send one answer line
+    /// @return False if the client is gone
+    bool send_line(int socket, std::string line)
+    {
+        line += '\n';
+        std::size_t sent = 0;
+        while (sent < line.size())
+        {
+            ssize_t length = send(socket, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+            if (length <= 0)
+            {
+                return false;
+            }
+            sent += length;
+        }
+        return true;
+    }
+
+    /// @brief Check without blocking if the client closed its connection
+    bool disconnected(int socket)
+    {
+        char byte;
+        return recv(socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+    }
+
+    /// @brief Check if a request may set an option, requests cannot write files or change the machine setup,
+    ///        the instance path they read is confined to the instance root by the service
+    bool request_option(std::string const &name)
+    {
+        static std::vector<std::string> const options{"instance", "solver", "time", "target", "seed", "tabu", "tabu-cutoff"};
+        static std::vector<std::string> const parameters = parameter_names();
+        return std::find(options.begin(), options.end(), name) != options.end() ||
+               std::find(parameters.begin(), parameters.end(), name) != parameters.end();
+    }
+
+    /// @brief Parse a request line of --{name} {value} or --{name}={value} options
+    /// @param line Request line
+    /// @param request Receives the options
+    /// @param error Receives the reason if an option is refused or invalid
+    /// @return False if the request has to be answered with an error
+    bool parse_request(std::string const &line, RunOptions &request, std::string &error)
+    {
+        std::vector<std::string> arguments{"gummy"};
+        std::istringstream words(line);
+        for (std::string word; words >> word;)
+        {
+            if (word.compare(0, 2, "--") != 0)
+            {
+                error = "unexpected argument " + word + ", requests name every option";
+                return false;
+            }
+            std::string name = word.substr(2, word.find('=') - 2);
+            if (!request_option(name))
+            {
+                error = "option --" + name + " is not available to requests";
+                return false;
+            }
+            arguments.push_back(word);
+            if (word.find('=') == std::string::npos && words >> word)
+            {
+                arguments.push_back(word);
+            }
+        }
+        std::vector<char const *> argv;
+        for (auto const &argument : arguments)
+        {
+            argv.push_back(argument.c_str());
+        }
+        return parse_options(argv.size(), argv.data(), request, error);
+    }
+
+    /// @brief Queue of accepted connections served by a pool of workers
+    class SolveService
+    {
+    public:
+        SolveService(ServerOptions const &options)
+            : _options(options),
+              _cache(options.cache_size),
+              _configurations(),
+              _rules(options.rules_path.empty() ? default_selection_rules() : read_selection_rules(options.rules_path)),
+              _root(std::filesystem::weakly_canonical(options.instance_root.empty() ? std::filesystem::current_path()
+                                                                                     : std::filesystem::path(options.instance_root))),
+              _waiting(),
+              _running{0},
+              _served{0}
+        {
+            if (!options.configuration_path.empty())
+            {
+                _configurations = read_configurations(options.configuration_path);
+            }
+        }
+        /// @brief Queue a connection or turn it away if the queue is full
+        void admit(int connection)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_waiting.size() >= _options.queue_limit)
+            {
+                send_line(connection, "BUSY " + std::to_string(_running) + " " + std::to_string(_waiting.size()));
+                close(connection);
+                return;
+            }
+            send_line(connection, "ACCEPTED " + std::to_string(_waiting.size()));
+            _waiting.push_back(connection);
+            _ready.notify_one();
+        }
+        /// @brief Serve queued connections forever
+        void work()
+        {
+            while (true)
+            {
+                int connection;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _ready.wait(lock, [this]()
+                                { return !_waiting.empty(); });
+                    connection = _waiting.front();
+                    _waiting.pop_front();
+                    _running++;
+                }
+                this->_serve(connection);
+                close(connection);
+                std::lock_guard<std::mutex> lock(_mutex);
+                _running--;
+                if (++_served % 100 == 0)
+                {
+                    std::cout << _served << " requests served, " << _cache.summary() << std::endl;
+                }
+            }
+        }
+
+    private:
+        ServerOptions const &_options;
+        InstanceCache _cache;
+        std::map<std::string, SolverConfiguration> _configurations;
+        std::vector<SelectionRule> _rules;
+        std::filesystem::path _root;
+        std::mutex _mutex;
+        std::condition_variable _ready;
+        std::deque<int> _waiting;
+        unsigned _running;
+        unsigned long _served;
+
+        /// @brief Resolve a request's instance path inside the instance root
+        /// @return False if the path leads out of the root, also through a symbolic link
+        bool _resolve(std::string const &instance, std::string &path) const
+        {
+            std::error_code status;
+            std::filesystem::path resolved = std::filesystem::weakly_canonical(_root / instance, status);
+            if (status)
+            {
+                return false;
+            }
+            auto relative = resolved.lexically_relative(_root);
+            if (relative.empty() || *relative.begin() == "..")
+            {
+                return false;
+            }
+            path = resolved.string();
+            return true;
+        }
+
+        void _serve(int connection)
+        {
+            timeval timeout{request_timeout, 0};
+            setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            SocketBuffer buffer(connection);
+            std::istream stream(&buffer);
+            std::string line;
+            if (!std::getline(stream, line))
+            {
+                return;
+            }
+            // the request line uses the syntax of the command line, limited to the options of a solve
+            RunOptions request;
+            std::string error;
+            if (!parse_request(line, request, error))
+            {
+                send_line(connection, "ERROR " + error);
+                return;
+            }
+            if (request.instance.empty())
+            {
+                send_line(connection, "ERROR the request needs --instance {file}, or --instance - followed by the instance");
+                return;
+            }
+            // the footprint is estimated for the largest solver so that a cached matrix suits every request
+            auto fits = [this, &error](unsigned n, unsigned terms, Matrix::Storage &storage)
+            {
+                if (!choose_storage(std::size_t(_options.memory_limit) << 20, estimate_memory("AUTO", n, terms), storage))
+                {
+                    error = "an instance of " + std::to_string(n) + " variables and " + std::to_string(terms) +
+                            " terms exceeds the server's memory limit of " + std::to_string(_options.memory_limit) + " MiB";
+                    return false;
+                }
+                return true;
+            };
+            std::shared_ptr<Matrix const> matrix;
+            if (request.instance == "-")
+            {
+                matrix = std::make_shared<Matrix const>(read_instance(stream, Matrix::Storage::dense_double, fits));
+                if (matrix->size() == 0 && error.empty())
+                {
+                    error = "the streamed instance is not valid QPLIB";
+                }
+            }
+            else
+            {
+                std::string path;
+                if (!_resolve(request.instance, path))
+                {
+                    send_line(connection, "ERROR " + request.instance + " is outside the server's instance root");
+                    return;
+                }
+                matrix = _cache.get(path, fits, error);
+            }
+            if (matrix == nullptr || matrix->size() == 0)
+            {
+                send_line(connection, "ERROR " + (error.empty() ? std::string("no instance received") : error));
+                return;
+            }
+
+            SolverConfiguration configuration = configure_solver(request.solver, *matrix, _rules, _configurations, request.parameters);
+            std::unique_ptr<Heuristic> heuristic(create_heuristic(configuration, *matrix, request.has_seed ? request.seed : std::random_device()()));
+            if (heuristic == nullptr)
+            {
+                send_line(connection, "ERROR unknown solver " + configuration.solver);
+                return;
+            }
+            if (request.has_target)
+            {
+                heuristic->set_target(request.target);
+            }
+
+            // stream improvements, a gone client stops the solve through an unreachable target
+            auto start_time = std::chrono::steady_clock::now();
+            auto seconds = [&start_time]()
+            {
+                return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            };
+            double reported_value = -std::numeric_limits<double>::infinity();
+            Heuristic *solver = heuristic.get();
+            heuristic->set_iteration_callback([&, solver](std::vector<bool> const &, double best_value)
+                                              {
+                bool connected = !disconnected(connection);
+                if (connected && best_value > reported_value)
+                {
+                    reported_value = best_value;
+                    std::ostringstream incumbent;
+                    incumbent << "INCUMBENT " << std::setprecision(15) << best_value << " " << std::setprecision(3) << seconds();
+                    connected = send_line(connection, incumbent.str());
+                }
+                if (!connected)
+                {
+                    solver->set_target(-std::numeric_limits<double>::infinity());
+                } });
+            // the server's limit also caps what a request may ask for
+            heuristic->solve(request.time_limit > 0 ? std::min(request.time_limit, _options.time_limit) : _options.time_limit);
+
+            std::vector<bool> solution = heuristic->get_solution();
+            double value = evaluate(SparseMatrix(*matrix), solution);
+            std::ostringstream result;
+            result << "RESULT " << std::setprecision(15) << value << " " << std::setprecision(3) << seconds() << " ";
+            for (bool bit : solution)
+            {
+                result << (bit ? '1' : '0');
+            }
+            send_line(connection, result.str());
+            std::cout << configuration.solver << " " << request.instance << " " << std::setprecision(15) << value << " " << std::setprecision(3) << seconds() << "s" << std::endl;
+        }
+    };
+}
+
+InstanceCache::InstanceCache(unsigned capacity)
+    : _capacity{std::max(1u, capacity)},
+      _entries(),
+      _hits{0},
+      _misses{0} {}
+auto InstanceCache::get(std::string const &path, InstanceCheck const &check, std::string &error) -> std::shared_ptr<Matrix const>
+{
+    std::error_code status;
+    auto modified = std::filesystem::last_write_time(path, status);
+    if (status)
+    {
+        error = "cannot read " + path;
+        return nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto entry = _entries.begin(); entry != _entries.end(); entry++)
+        {
+            if (entry->path == path && entry->modified == modified)
+            {
+                _hits++;
+                _entries.splice(_entries.begin(), _entries, entry);
+                return entry->matrix;
+            }
+        }
+        _misses++;
+    }
+    // parse without the lock, two requests missing on the same file at once both parse it
+    auto matrix = std::make_shared<Matrix const>(read_file_test(path, Matrix::Storage::dense_double, check));
+    if (matrix->size() == 0)
+    {
+        if (error.empty())
+        {
+            error = path + " is not a QPLIB instance";
+        }
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.remove_if([&path](Entry const &entry)
+                       { return entry.path == path; });
+    _entries.push_front(Entry{path, modified, matrix});
+    if (_entries.size() > _capacity)
+    {
+        _entries.pop_back();
+    }
+    return matrix;
+}
+auto InstanceCache::summary() -> std::string
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return "instance cache: " + std::to_string(_hits) + " hits, " + std::to_string(_misses) + " misses, " +
+           std::to_string(_entries.size()) + " cached";
+}
+
+auto run_server(ServerOptions const &options) -> bool
+{
+    std::vector<char> address;
+    std::string error;
+    if (!resolve_address(options.address, address, error))
+    {
+        std::cout << error << std::endl;
+        return false;
+    }
+    int family = reinterpret_cast<sockaddr const *>(address.data())->sa_family;
+    int listener = socket(family, SOCK_STREAM, 0);
+    if (listener == -1)
+    {
+        std::cout << "Cannot create socket" << std::endl;
+        return false;
+    }
+    if (family == AF_UNIX)
+    {
+        unlink(options.address.c_str());
+    }
+    else
+    {
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    if (bind(listener, reinterpret_cast<sockaddr const *>(address.data()), address.size()) == -1 || listen(listener, 64) == -1)
+    {
+        std::cout << "Cannot listen on " << options.address << ": " << std::strerror(errno) << std::endl;
+        close(listener);
+        return false;
+    }
+    std::cout << "Serving on " << options.address << " with " << options.workers << " workers" << std::endl;
+
+    SolveService service(options);
+    std::vector<std::thread> pool;
+    for (unsigned worker = 0; worker < std::max(1u, options.workers); worker++)
+    {
+        pool.emplace_back([&service]()
+                          { service.work(); });
+    }
+    while (true)
+    {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection != -1)
+        {
+            service.admit(connection);
+        }
+    }
+}
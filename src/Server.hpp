@@ -0,0 +1,86 @@
+/**
+ * @file Server.hpp
+ * @author Gennesaret Tjusila
+ * @brief Long running solve service with a cache of parsed instances
+ */
+#ifndef Server_H
+#define Server_H
+#include "Matrix.hpp"
+#include "read_file.hpp"
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/// @brief Parsed instances by path, the least recently used one is dropped first
+///
+/// An entry is parsed again when the file changed on disk. The matrices are shared
+/// read only between the solves using them.
+class InstanceCache
+{
+public:
+    /// @brief Create an empty cache
+    /// @param capacity Instances kept at most
+    InstanceCache(unsigned capacity);
+    /// @brief Get the matrix of an instance, parsing it on a miss
+    /// @param path QPLIB .qs file
+    /// @param check Decides from the header of a missed file if it is read and in which storage
+    /// @param error Receives the reason if the file cannot be read
+    /// @return Matrix, nullptr on error
+    std::shared_ptr<Matrix const> get(std::string const &path, InstanceCheck const &check, std::string &error);
+    /// @brief Number of hits and misses so far
+    std::string summary();
+
+private:
+    struct Entry
+    {
+        std::string path;
+        std::filesystem::file_time_type modified;
+        std::shared_ptr<Matrix const> matrix;
+    };
+    unsigned _capacity;
+    // most recently used first
+    std::list<Entry> _entries;
+    unsigned long _hits;
+    unsigned long _misses;
+    std::mutex _mutex;
+};
+
+/// @brief Settings of a solve service
+struct ServerOptions
+{
+    /// @brief Listening address, a Unix domain socket path or host:port for TCP
+    std::string address;
+    /// @brief Solves run at the same time
+    unsigned workers = 1;
+    /// @brief Requests waiting for a worker at most, more are answered with BUSY
+    unsigned queue_limit = 16;
+    /// @brief Instances kept parsed
+    unsigned cache_size = 8;
+    /// @brief Time limit of requests without --time, and the longest a request may ask for
+    unsigned time_limit = 600;
+    /// @brief Tuned parameters per instance class, optional
+    std::string configuration_path;
+    /// @brief Solver selection rules of AUTO, the built-in ones if empty
+    std::string rules_path;
+    /// @brief MiB an instance and its solve may take, larger instances are answered with ERROR
+    unsigned memory_limit = 1024;
+    /// @brief Directory requests may read instances from, the working directory if empty
+    std::string instance_root;
+};
+
+/// @brief Serve solve requests until the process is stopped
+///
+/// A client connects, sends one line of command line options (only --instance, --solver, --time,
+/// --target, --seed, --tabu, --tabu-cutoff and solver parameters) and reads the answer lines:
+/// "ACCEPTED {position}" or "BUSY {running} {waiting}", then "INCUMBENT {value} {seconds}" whenever
+/// the solver improved and finally "RESULT {value} {seconds} {solution as 0/1 string}" or "ERROR {reason}".
+/// With "--instance -" the instance follows the request line in QPLIB format and is not cached, other
+/// instance paths are relative to the instance root and may not leave it. Instances whose estimated
+/// footprint with the largest solver exceeds the memory limit are refused before they are read.
+/// A client that disconnects stops its solve.
+/// @param options Server settings
+/// @return False if the address cannot be bound
+bool run_server(ServerOptions const &options);
+#endif
@@ -0,0 +1,202 @@
+#include "SharedSolutions.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+VersionedSolution::VersionedSolution(unsigned size)
+    : _sequence{0},
+      _value{-std::numeric_limits<double>::infinity()},
+      _word_count{(size + 63) / 64},
+      _words(new std::atomic<std::uint64_t>[(size + 63) / 64])
+{
+    for (unsigned word = 0; word < _word_count; word++)
+    {
+        _words[word].store(0, std::memory_order_relaxed);
+    }
+}
+auto VersionedSolution::read(std::vector<std::uint64_t> &words, double &value) const -> std::uint64_t
+{
+    words.resize(_word_count);
+    while (true)
+    {
+        std::uint64_t before = _sequence.load(std::memory_order_acquire);
+        if (before % 2 == 1)
+        {
+            continue;
+        }
+        for (unsigned word = 0; word < _word_count; word++)
+        {
+            words[word] = _words[word].load(std::memory_order_relaxed);
+        }
+        value = _value.load(std::memory_order_relaxed);
+        // the copy must not be reordered past the second look at the sequence
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == before)
+        {
+            return before;
+        }
+    }
+}
+auto VersionedSolution::write(std::uint64_t sequence, std::vector<std::uint64_t> const &words, double value) -> bool
+{
+    if (!_sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+    {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    for (unsigned word = 0; word < _word_count; word++)
+    {
+        _words[word].store(words[word], std::memory_order_relaxed);
+    }
+    _value.store(value, std::memory_order_relaxed);
+    _sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+auto VersionedSolution::clear() -> void
+{
+    _value.store(-std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+    _sequence.store(_sequence.load(std::memory_order_relaxed) + 2, std::memory_order_release);
+}
+
+auto pack_solution(std::vector<bool> const &solution) -> std::vector<std::uint64_t>
+{
+    std::vector<std::uint64_t> words((solution.size() + 63) / 64, 0);
+    for (unsigned i = 0; i < solution.size(); i++)
+    {
+        if (solution[i])
+        {
+            words[i / 64] |= std::uint64_t(1) << (i % 64);
+        }
+    }
+    return words;
+}
+auto unpack_solution(std::vector<std::uint64_t> const &words, unsigned size) -> std::vector<bool>
+{
+    std::vector<bool> solution(size, false);
+    for (unsigned i = 0; i < size; i++)
+    {
+        solution[i] = (words[i / 64] >> (i % 64)) & 1;
+    }
+    return solution;
+}
+
+SharedIncumbent::SharedIncumbent(unsigned size)
+    : _size{size},
+      _record(size) {}
+auto SharedIncumbent::publish(std::vector<bool> const &solution, double value) -> bool
+{
+    std::vector<std::uint64_t> words = pack_solution(solution);
+    while (true)
+    {
+        std::uint64_t sequence = _record.sequence();
+        if (value <= _record.value())
+        {
+            return false;
+        }
+        // an odd sequence fails the exchange, so a writer in progress is simply retried
+        if (sequence % 2 == 0 && _record.write(sequence, words, value))
+        {
+            return true;
+        }
+    }
+}
+auto SharedIncumbent::get(double &value) const -> std::vector<bool>
+{
+    std::vector<std::uint64_t> words;
+    _record.read(words, value);
+    return unpack_solution(words, _size);
+}
+
+SharedElitePool::SharedElitePool(unsigned size, unsigned capacity, unsigned min_distance)
+    : _size{size},
+      _min_distance{min_distance},
+      _members()
+{
+    for (unsigned member = 0; member < std::max(1u, capacity); member++)
+    {
+        _members.push_back(std::make_unique<VersionedSolution>(size));
+    }
+}
+auto SharedElitePool::insert(std::vector<bool> const &solution, double value) -> bool
+{
+    std::vector<std::uint64_t> words = pack_solution(solution);
+    std::vector<std::uint64_t> member_words;
+    while (true)
+    {
+        // pick the member to compete with from one pass over the pool
+        unsigned target = 0;
+        std::uint64_t target_sequence = 0;
+        double target_value = std::numeric_limits<double>::infinity();
+        unsigned nearest_distance = _min_distance;
+        for (unsigned member = 0; member < _members.size(); member++)
+        {
+            double member_value;
+            std::uint64_t sequence = _members[member]->read(member_words, member_value);
+            unsigned distance = 0;
+            if (_min_distance > 0 && member_value > -std::numeric_limits<double>::infinity())
+            {
+                for (unsigned word = 0; word < words.size(); word++)
+                {
+                    distance += std::bitset<64>(words[word] ^ member_words[word]).count();
+                }
+                if (distance < nearest_distance)
+                {
+                    nearest_distance = distance;
+                    target = member;
+                    target_sequence = sequence;
+                    target_value = member_value;
+                    continue;
+                }
+            }
+            if (nearest_distance == _min_distance && member_value < target_value)
+            {
+                target = member;
+                target_sequence = sequence;
+                target_value = member_value;
+            }
+        }
+        if (value <= target_value)
+        {
+            return false;
+        }
+        // another insert changed the member since it was read, decide again
+        if (_members[target]->write(target_sequence, words, value))
+        {
+            return true;
+        }
+    }
+}
+auto SharedElitePool::get(unsigned index, double &value) const -> std::vector<bool>
+{
+    std::vector<std::uint64_t> words;
+    _members[index]->read(words, value);
+    return unpack_solution(words, _size);
+}
+auto SharedElitePool::members() const -> std::vector<std::pair<double, std::vector<bool>>>
+{
+    std::vector<std::pair<double, std::vector<bool>>> members;
+    for (unsigned member = 0; member < _members.size(); member++)
+    {
+        double value;
+        std::vector<bool> solution = this->get(member, value);
+        if (value > -std::numeric_limits<double>::infinity())
+        {
+            members.emplace_back(value, solution);
+        }
+    }
+    std::sort(members.begin(), members.end(), [](auto const &a, auto const &b)
+              { return a.first > b.first; });
+    return members;
+}
+auto SharedElitePool::clear() -> void
+{
+    for (auto &member : _members)
+    {
+        member->clear();
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file SharedSolutions.hpp
+ * @author Gennesaret Tjusila
+ * @brief Incumbent and elite pool shared by solvers on several threads without a mutex
+ */
+#ifndef SharedSolutions_H
+#define SharedSolutions_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// @brief A solution and its value behind a sequence lock
+///
+/// The sequence is odd while a writer copies a solution in. Readers retry until they saw the
+/// same even sequence before and after copying, writers claim the record by moving the
+/// sequence they last read from even to odd, so a stale writer fails instead of waiting.
+class VersionedSolution
+{
+public:
+    /// @brief Create an empty record of value -infinity
+    /// @param size Problem size
+    VersionedSolution(unsigned size);
+    /// @brief Current sequence, even when no write is in progress
+    std::uint64_t sequence() const
+    {
+        return _sequence.load(std::memory_order_acquire);
+    }
+    /// @brief Value of the last completed or the ongoing write
+    double value() const
+    {
+        return _value.load(std::memory_order_acquire);
+    }
+    /// @brief Copy out a consistent solution and value
+    /// @param words Receives the solution packed 64 variables per word
+    /// @param value Receives the value
+    /// @return Sequence the copy belongs to
+    std::uint64_t read(std::vector<std::uint64_t> &words, double &value) const;
+    /// @brief Replace the solution if nothing was written since a read
+    /// @param sequence Sequence returned by the read the decision was based on
+    /// @param words Solution packed 64 variables per word
+    /// @param value Its value
+    /// @return False if another writer came first
+    bool write(std::uint64_t sequence, std::vector<std::uint64_t> const &words, double value);
+    /// @brief Empty the record, not safe while other threads use it
+    void clear();
+
+private:
+    std::atomic<std::uint64_t> _sequence;
+    std::atomic<double> _value;
+    unsigned _word_count;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> _words;
+};
+
+/// @brief Pack a solution 64 variables per word
+std::vector<std::uint64_t> pack_solution(std::vector<bool> const &solution);
+/// @brief Unpack a solution of pack_solution
+std::vector<bool> unpack_solution(std::vector<std::uint64_t> const &words, unsigned size);
+
+/// @brief Best solution found by any thread
+class SharedIncumbent
+{
+public:
+    /// @param size Problem size
+    SharedIncumbent(unsigned size);
+    /// @brief Offer a solution, kept only if it is better than the incumbent
+    /// @return True if it became the incumbent
+    bool publish(std::vector<bool> const &solution, double value);
+    /// @brief Best value so far, -infinity before the first publish
+    double value() const
+    {
+        return _record.value();
+    }
+    /// @brief Changes whenever a new incumbent is published
+    std::uint64_t version() const
+    {
+        return _record.sequence();
+    }
+    /// @brief Copy out the incumbent
+    /// @param value Receives its value
+    std::vector<bool> get(double &value) const;
+    /// @brief Forget the incumbent, not safe while other threads use it
+    void clear()
+    {
+        _record.clear();
+    }
+
+private:
+    unsigned _size;
+    VersionedSolution _record;
+};
+
+/// @brief Bounded pool of good and diverse solutions
+///
+/// Like the elite set of DTSS, the pool fills up and then replaces its worst member by better
+/// solutions. A solution within min_distance flips of a member competes with that member
+/// instead, so near copies of one solution cannot take over the pool. Every member is a
+/// VersionedSolution, inserts on different members do not wait for each other.
+class SharedElitePool
+{
+public:
+    /// @param size Problem size
+    /// @param capacity Members at most
+    /// @param min_distance Hamming distance below which two solutions count as the same region, 0 disables it
+    SharedElitePool(unsigned size, unsigned capacity, unsigned min_distance);
+    /// @brief Offer a solution
+    /// @return True if it entered the pool
+    bool insert(std::vector<bool> const &solution, double value);
+    /// @brief Copy out one member
+    /// @param index Member index below capacity()
+    /// @param value Receives its value, -infinity for an empty member
+    std::vector<bool> get(unsigned index, double &value) const;
+    /// @brief Copy out all members, best first
+    std::vector<std::pair<double, std::vector<bool>>> members() const;
+    unsigned capacity() const
+    {
+        return _members.size();
+    }
+    /// @brief Empty the pool, not safe while other threads use it
+    void clear();
+
+private:
+    unsigned _size;
+    unsigned _min_distance;
+    std::vector<std::unique_ptr<VersionedSolution>> _members;
+};
+#endif
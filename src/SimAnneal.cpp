@@ -1,13 +1,47 @@
 #include "SimAnneal.hpp"
+#include "Checkpoint.hpp"
+#include "Instrumentation.hpp"
 #include "Matrix.hpp"
+#include "SparseMatrix.hpp"
 #include <iostream>
 #include <random>
 #include <vector>
 #include <algorithm>
 #include <climits>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+    /// @brief Consecutive variables a sweep visits before jumping to another block
+    constexpr unsigned visit_block_size = 64;
+    /// @brief Bits of the quantized uniforms of the acceptance test, as in MultiSpinAnneal
+    constexpr unsigned uniform_bits = 10;
+
+    /// @brief log(u) at the bounds u = k / 2^uniform_bits of the buckets of (0, 1), ascending from -inf to 0
+    std::vector<double> const &log_bounds()
+    {
+        static std::vector<double> const table = []()
+        {
+            std::vector<double> logs((std::size_t(1) << uniform_bits) + 1);
+            logs[0] = -std::numeric_limits<double>::infinity();
+            for (std::size_t k = 1; k < logs.size(); k++)
+            {
+                logs[k] = std::log(std::ldexp(double(k), -int(uniform_bits)));
+            }
+            return logs;
+        }();
+        return table;
+    }
+}
 
 SimAnneal::SimAnneal(Matrix const &matrix, unsigned size)
+    : SimAnneal(matrix, size, std::random_device()()) {}
+
+SimAnneal::SimAnneal(Matrix const &matrix, unsigned size, unsigned seed)
     : _matrix{matrix},
       _size{size},
       output(),
@@ -16,13 +50,21 @@ SimAnneal::SimAnneal(Matrix const &matrix, unsigned size)
       _column_value(size, 0),
       _current_solution(size, false),
       _best_solution(size, false),
-      _random_engine(std::random_device()())
+      _random_engine(seed),
+      _sparse(matrix),
+      _threshold((std::size_t(1) << uniform_bits) + 1, 0),
+      _block_order((size + visit_block_size - 1) / visit_block_size)
 {
+    std::iota(_block_order.begin(), _block_order.end(), 0);
     _iter_count = 1000;
     _anneal_count = 10;
     _t_factor = 0.99;
     _init_t_factor = 1;
     _init_t = 0.1 * _size;
+    _temperature = _init_t;
+    _sa_count = 0;
+    _initialized = false;
+    _warm_started = false;
 }
 
 SimAnneal::SimAnneal(Matrix const &matrix, unsigned size, double Tinit, double Tfactor, unsigned annealCount, double TinitFactor, unsigned iterCount)
@@ -33,48 +75,125 @@ SimAnneal::SimAnneal(Matrix const &matrix, unsigned size, double Tinit, double T
       _column_value(size, 0),
       _current_solution(size, false),
       _best_solution(size, false),
-      _random_engine(std::random_device()())
+      _random_engine(std::random_device()()),
+      _sparse(matrix),
+      _threshold((std::size_t(1) << uniform_bits) + 1, 0),
+      _block_order((size + visit_block_size - 1) / visit_block_size)
 {
+    std::iota(_block_order.begin(), _block_order.end(), 0);
     _iter_count = iterCount;
     _anneal_count = annealCount;
     _t_factor = Tfactor;
     _init_t_factor = TinitFactor;
     _init_t = Tinit;
+    _temperature = _init_t;
+    _sa_count = 0;
+    _initialized = false;
+    _warm_started = false;
+}
+
+auto SimAnneal::set_parameters(SAParameters const &parameters) -> void
+{
+    _iter_count = parameters.run_count;
+    _anneal_count = parameters.anneal_count;
+    _t_factor = parameters.cooling_factor;
+    _init_t_factor = parameters.restart_factor;
+    _init_t = parameters.initial_temperature > 0 ? parameters.initial_temperature : 0.1 * _size;
+    _temperature = _init_t;
 }
 
 auto SimAnneal::_initialize() -> void
 {
-    std::uniform_real_distribution<> dis(0, 1.0);
-    for (unsigned i = 0; i < _size; i++)
+    // a warm start keeps the supplied solution
+    if (!_warm_started)
     {
-        if (dis(_random_engine) > 0.5)
+        std::uniform_real_distribution<> dis(0, 1.0);
+        for (unsigned i = 0; i < _size; i++)
         {
-            _current_solution[i] = !_current_solution[i];
+            if (dis(_random_engine) > 0.5)
+            {
+                _current_solution[i] = !_current_solution[i];
+            }
         }
     }
     this->_recompute_internal_variables();
 }
 
+auto SimAnneal::warm_start(std::vector<std::vector<bool>> const &solutions) -> void
+{
+    std::vector<bool> best_start;
+    double best_start_value = INT_MIN;
+    for (auto const &solution : solutions)
+    {
+        if (solution.size() != _size)
+        {
+            continue;
+        }
+        _current_solution = solution;
+        this->_recompute_internal_variables();
+        if (best_start.empty() || _current_value > best_start_value)
+        {
+            best_start = solution;
+            best_start_value = _current_value;
+        }
+    }
+    if (!best_start.empty())
+    {
+        _current_solution = best_start;
+        _warm_started = true;
+    }
+}
+
 auto SimAnneal::_recompute_internal_variables() -> void
 {
     std::fill(_row_value.begin(), _row_value.end(), 0);
     std::fill(_column_value.begin(), _column_value.end(), 0);
     for (unsigned i = 0; i < _size; i++)
     {
-        for (unsigned j = 0; j < i; j++)
+        for (auto entry = _sparse.begin(i); entry != _sparse.end(i); ++entry)
         {
-            _row_value[i] += _matrix(i, j) * _current_solution[j];
-            _column_value[j] += _matrix(i, j) * _current_solution[i];
+            unsigned j = entry->column;
+            if (j < i)
+            {
+                _row_value[i] += entry->value * _current_solution[j];
+                _column_value[j] += entry->value * _current_solution[i];
+            }
         }
     }
     _current_value = 0;
     for (unsigned i = 0; i < _size; i++)
     {
-        _current_value += (_row_value[i] + _matrix(i, i)) * _current_solution[i];
+        _current_value += (_row_value[i] + _sparse.diagonal(i)) * _current_solution[i];
     }
     for (unsigned i = 0; i < _size; i++)
     {
-        _delta_x[i] = (1 - 2 * _current_solution[i]) * (_row_value[i] + _column_value[i] + _matrix(i, i));
+        _delta_x[i] = (1 - 2 * _current_solution[i]) * (_row_value[i] + _column_value[i] + _sparse.diagonal(i));
+    }
+}
+
+auto SimAnneal::_adopt_migrants() -> void
+{
+    // continue from the best solution of another search if it beats the current one
+    bool adopted = false;
+    for (auto const &[value, solution] : _migrants)
+    {
+        if (solution.size() == _size && value > _current_value)
+        {
+            _current_solution = solution;
+            _current_value = value;
+            adopted = true;
+        }
+    }
+    _migrants.clear();
+    if (!adopted)
+    {
+        return;
+    }
+    this->_recompute_internal_variables();
+    if (_current_value > _best_value)
+    {
+        _best_value = _current_value;
+        std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
     }
 }
 
@@ -89,48 +208,62 @@ auto SimAnneal::solve(unsigned time_limit) -> void
     start_time_ms = std::chrono::high_resolution_clock::now();
 
     // Step 1
-    double Tinit = _init_t;
     double TFactor = _t_factor;
     unsigned TermCount = _anneal_count;
     unsigned SACount = _iter_count;
     double StartTFactor = _init_t_factor;
 
     // Step 2
-    this->_initialize();
-    std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
-    _best_value = _current_value;
+    // a restored checkpoint continues with its temperature
+    if (!_initialized)
+    {
+        this->_initialize();
+        std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
+        _best_value = _current_value;
+        _initialized = true;
+    }
 
     unsigned iter_count = 0;
 
     // Step 3
-    while (iter_count < SACount)
+    while (_sa_count < SACount)
     {
         start_time_inside = std::chrono::high_resolution_clock::now();
+        this->_adopt_migrants();
 
         // Step 3.2
-        this->_simulated_annealing(Tinit, TFactor, TermCount);
+        this->_simulated_annealing(_temperature, TFactor, TermCount);
 
         // Step 3.3
         // cool down the temperature
-        Tinit = StartTFactor * Tinit;
+        _temperature = StartTFactor * _temperature;
 
         ++iter_count;
+        ++_sa_count;
+        GUMMY_COUNT(_statistics, restarts, 1);
 
         //std::cout << "Iteration: " << iter_count << " Current Best: " << _best_value << endl;
 
         duration_ms = (std::chrono::high_resolution_clock::now() - start_time_ms) / 1000;
         duration_inside = (std::chrono::high_resolution_clock::now() - start_time_inside) / 1000;
 
-        output += "Iteration: ";
-        output += std::to_string(iter_count);
-        output += ";Local Best: ";
-        output += std::to_string(_current_value);
-        output += ";Current Best: ";
-        output += std::to_string(_best_value);
-        output += ";time: ";
-        output += std::to_string(duration_inside.count());
-        output += "\n";
+        {
+            GUMMY_PHASE(_statistics, Phase::logging);
+            output += "Iteration: ";
+            output += std::to_string(_sa_count);
+            output += ";Local Best: ";
+            output += std::to_string(_current_value);
+            output += ";Current Best: ";
+            output += std::to_string(_best_value);
+            output += ";time: ";
+            output += std::to_string(duration_inside.count());
+            output += "\n";
+        }
 
+        if (this->_end_of_iteration(_best_solution, _best_value))
+        {
+            break;
+        }
         if (duration_ms.count() + duration_ms.count() / iter_count >= time_limit)
         {
             break;
@@ -140,9 +273,7 @@ auto SimAnneal::solve(unsigned time_limit) -> void
 
 auto SimAnneal::_simulated_annealing(double Tinit, double Tfactor, unsigned TermCount) -> void
 {
-    std::vector<unsigned> perm(_size);
     std::uniform_real_distribution<> dis(0, 1.0);
-    std::iota(perm.begin(), perm.end(), 0);
 
     // Step 1
     double T = Tinit;
@@ -155,41 +286,53 @@ auto SimAnneal::_simulated_annealing(double Tinit, double Tfactor, unsigned Term
         Counter += 1;
 
         // Step 3.2
-        std::shuffle(perm.begin(), perm.end(), std::mt19937(_random_engine));
+        // visit blocks of consecutive variables in random order, cheaper than a full permutation
+        std::shuffle(_block_order.begin(), _block_order.end(), _random_engine);
+        // acceptance thresholds T * log(u) at the bucket bounds for this temperature
+        for (std::size_t k = 0; k < _threshold.size(); k++)
+        {
+            _threshold[k] = T * log_bounds()[k];
+        }
 
         // Step 3.3
-        for (unsigned j = 0; j < _size; j++)
+        for (unsigned block : _block_order)
         {
-            // Step 3.3.1
-            int k = perm[j];
-
-            // Step 2
-            double delta = (1 - 2 * _current_solution[k]) * (_row_value[k] + _column_value[k] + _matrix(k, k));
-
-            // Step 3.3.2
-            if (delta > 0)
+            unsigned block_end = std::min(_size, (block + 1) * visit_block_size);
+            for (unsigned k = block * visit_block_size; k < block_end; k++)
             {
-                Counter = 0;
-                _current_solution[k] = !_current_solution[k];
-                _current_value += delta;
-                this->_recompute_internal_variables();
-
-                if (_current_value > _best_value)
+                GUMMY_COUNT(_statistics, moves_evaluated, 1);
+                double delta = _delta_x[k];
+                // Metropolis: accept if u < exp(delta / T), that is T * log(u) < delta. Improvements pass without
+                // a draw. Otherwise the bucket of u decides, unless delta lies within its thresholds, which happens
+                // with probability 2^-uniform_bits, and only then u is drawn exactly inside the bucket
+                if (delta < 0)
                 {
-                    _best_value = _current_value;
-                    std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
+                    std::uint32_t bucket = _random_engine() >> (32 - uniform_bits);
+                    bool accept = delta > _threshold[bucket + 1];
+                    if (!accept && delta > _threshold[bucket])
+                    {
+                        accept = delta > T * std::log(std::ldexp(bucket + dis(_random_engine), -int(uniform_bits)));
+                    }
+                    if (!accept)
+                    {
+                        continue;
+                    }
+                }
+                {
+                    GUMMY_PHASE(_statistics, Phase::update);
+                    GUMMY_COUNT(_statistics, flips_applied, 1);
+                    this->_flip(k);
                 }
-            }
 
-            // Step 3.3.3
-            else
-            {
-                std::mt19937 gen(1);
-                if (dis(gen) < exp(delta / T))
+                // Step 3.3.2
+                if (delta > 0)
                 {
-                    _current_solution[k] = !_current_solution[k];
-                    _current_value += delta;
-                    this->_recompute_internal_variables();
+                    Counter = 0;
+                    if (_current_value > _best_value)
+                    {
+                        _best_value = _current_value;
+                        std::copy(_current_solution.begin(), _current_solution.end(), _best_solution.begin());
+                    }
                 }
             }
         }
@@ -200,6 +343,29 @@ auto SimAnneal::_simulated_annealing(double Tinit, double Tfactor, unsigned Term
     }
 }
 
+auto SimAnneal::_flip(unsigned k) -> void
+{
+    // only the neighbours of k see their row or column value change
+    double sign = 1 - 2 * int(_current_solution[k]);
+    for (auto entry = _sparse.begin(k); entry != _sparse.end(k); ++entry)
+    {
+        unsigned j = entry->column;
+        double change = sign * entry->value;
+        if (j < k)
+        {
+            _column_value[j] += change;
+        }
+        else
+        {
+            _row_value[j] += change;
+        }
+        _delta_x[j] += (1 - 2 * int(_current_solution[j])) * change;
+    }
+    _current_solution[k] = !_current_solution[k];
+    _current_value += _delta_x[k];
+    _delta_x[k] = -_delta_x[k];
+}
+
 auto SimAnneal::get_solution() -> std::vector<bool>
 {
     return _best_solution;
@@ -208,4 +374,54 @@ auto SimAnneal::get_solution() -> std::vector<bool>
 auto SimAnneal::get_output() -> std::string
 {
     return output;
-}
\ No newline at end of file
+}
+auto SimAnneal::save_checkpoint(std::ostream &stream) -> void
+{
+    write_header(stream, "SA", _size);
+    write_random_engine(stream, _random_engine);
+    write_solution(stream, _current_solution);
+    write_solution(stream, _best_solution);
+    write_value<double>(stream, _best_value);
+    write_value<double>(stream, _temperature);
+    write_value<unsigned>(stream, _sa_count);
+}
+
+auto SimAnneal::load_checkpoint(std::istream &stream) -> bool
+{
+    if (!read_header(stream, "SA", _size))
+    {
+        return false;
+    }
+    read_random_engine(stream, _random_engine);
+    _current_solution = read_solution(stream, _size);
+    _best_solution = read_solution(stream, _size);
+    _best_value = read_value<double>(stream);
+    _temperature = read_value<double>(stream);
+    _sa_count = read_value<unsigned>(stream);
+    this->_recompute_internal_variables();
+    _initialized = true;
+    return bool(stream);
+}
+
+auto SimAnneal::update_instance(std::vector<QuboEdit> const &changes) -> void
+{
+    for (auto const &change : changes)
+    {
+        unsigned i = change.row;
+        unsigned j = change.column;
+        _sparse.add(i, j, change.value);
+        if (i == j)
+        {
+            _current_value += change.value * _current_solution[i];
+            _best_value += change.value * _best_solution[i];
+            _delta_x[i] += (1 - 2 * _current_solution[i]) * change.value;
+            continue;
+        }
+        _row_value[i] += change.value * _current_solution[j];
+        _column_value[j] += change.value * _current_solution[i];
+        _current_value += change.value * _current_solution[i] * _current_solution[j];
+        _best_value += change.value * _best_solution[i] * _best_solution[j];
+        _delta_x[i] += (1 - 2 * _current_solution[i]) * change.value * _current_solution[j];
+        _delta_x[j] += (1 - 2 * _current_solution[j]) * change.value * _current_solution[i];
+    }
+}
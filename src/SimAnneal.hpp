@@ -8,17 +8,52 @@
 
 #include "Heuristic.hpp"
 #include "Matrix.hpp"
+#include "SparseMatrix.hpp"
+#include <iostream>
 #include <random>
+#include <vector>
+
+/// @brief Tunable constants of SimAnneal
+struct SAParameters
+{
+    /// @brief Start temperature, 0 uses 0.1 * n
+    double initial_temperature = 0;
+    /// @brief Cooling factor per annealing step, in (0, 1)
+    double cooling_factor = 0.99;
+    /// @brief Unimproved steps before an annealing run ends
+    unsigned anneal_count = 10;
+    /// @brief Start temperature factor from one run to the next, above 0
+    double restart_factor = 1;
+    /// @brief Number of annealing runs
+    unsigned run_count = 1000;
+};
 
 class SimAnneal : public Heuristic
 {
 
 public:
     SimAnneal(Matrix const &matrix, unsigned size);
+    SimAnneal(Matrix const &matrix, unsigned size, unsigned seed);
     SimAnneal(Matrix const &matrix, unsigned size, double Tinit, double Tfactor, unsigned AnnealCount, double TinitFactor, unsigned iterCount);
     void solve(unsigned time_limit) override;
     std::vector<bool> get_solution() override;
     std::string get_output() override;
+    /// @brief Start from the best of the supplied solutions
+    /// @param solutions Initial solutions
+    void warm_start(std::vector<std::vector<bool>> const &solutions) override;
+    /// @brief Patch the gain vectors and objective values in O(changes)
+    /// @param changes Coefficient differences
+    void update_instance(std::vector<QuboEdit> const &changes) override;
+    /// @brief Write incumbent, temperature, counters and RNG state
+    /// @param stream Binary output stream
+    void save_checkpoint(std::ostream &stream) override;
+    /// @brief Restore a checkpoint written by save_checkpoint
+    /// @param stream Binary input stream
+    /// @return False if the checkpoint does not match
+    bool load_checkpoint(std::istream &stream) override;
+    /// @brief Replace the schedule constants, call before the first solve
+    /// @param parameters SA parameters
+    void set_parameters(SAParameters const &parameters);
 
 private:
     std::string output;
@@ -29,11 +64,21 @@ private:
     /// @param TermCount Cooling duration count
     auto _simulated_annealing(double Tinit, double Tfactor, unsigned TermCount) -> void;
     auto _recompute_internal_variables() -> void;
+    /// @brief Flip a variable and update the gains of its neighbours in O(degree)
+    auto _flip(unsigned k) -> void;
+    /// @brief Continue from an immigrated solution that beats the current one
+    auto _adopt_migrants() -> void;
     double _init_t;
     double _init_t_factor;
     double _t_factor;
     unsigned _iter_count;
     unsigned _anneal_count;
+    /// @brief Start temperature of the next annealing run
+    double _temperature;
+    /// @brief Completed annealing runs
+    unsigned _sa_count;
+    bool _initialized;
+    bool _warm_started;
 
     unsigned _size;
     double _best_value;
@@ -46,6 +91,11 @@ private:
     std::vector<bool> _current_solution;
     std::vector<bool> _best_solution;
     std::mt19937 _random_engine;
+    SparseMatrix _sparse;
+    /// @brief T * log(u) at the bucket bounds of the acceptance uniforms, for the temperature of the current sweep
+    std::vector<double> _threshold;
+    /// @brief Block visit order of a sweep
+    std::vector<unsigned> _block_order;
 };
 
 #endif // !SimAnneal_H
\ No newline at end of file
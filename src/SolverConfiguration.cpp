@@ -0,0 +1,330 @@
+#include "SolverConfiguration.hpp"
+#include "DTSSearch.hpp"
+#include "Heuristic.hpp"
+#include "ExactSubproblem.hpp"
+#include "Matrix.hpp"
+#include "MSTSearch.hpp"
+#include "MultiSpinAnneal.hpp"
+#include "SimAnneal.hpp"
+#include "SparseMatrix.hpp"
+#include "TabuPolicy.hpp"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    /// @brief Parse a number, the whole string has to be consumed
+    template <typename T>
+    bool parse(std::string const &text, T &value)
+    {
+        // streams read "-1" into an unsigned as its wrapped value
+        std::size_t first = text.find_first_not_of(" \t");
+        if (std::is_unsigned<T>::value && first != std::string::npos && text[first] == '-')
+        {
+            return false;
+        }
+        std::istringstream stream(text);
+        T parsed;
+        if (!(stream >> parsed) || !stream.eof())
+        {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+    /// @brief Parse a number and keep it only if it is in range
+    template <typename T, typename Check>
+    bool parse(std::string const &text, T &value, Check in_range)
+    {
+        T parsed;
+        if (!parse(text, parsed) || !in_range(parsed))
+        {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+    bool is_fraction(double value)
+    {
+        return value > 0 && value <= 1;
+    }
+    template <typename T>
+    std::string format(T value)
+    {
+        std::ostringstream stream;
+        stream << value;
+        return stream.str();
+    }
+}
+
+auto parameter_names() -> std::vector<std::string>
+{
+    return {"dtss.elite_size", "dtss.pick_fraction",
+            "msts.alpha", "msts.lambda", "msts.exact_size", "msts.exact_rounds",
+            "tabu.adaptive", "tabu.tenure_cap", "tabu.tenure_random", "tabu.cutoff", "tabu.pair_moves",
+            "sa.initial_temperature", "sa.cooling_factor", "sa.anneal_count", "sa.restart_factor", "sa.run_count"};
+}
+auto set_parameter(SolverConfiguration &configuration, std::string const &name, std::string const &value) -> bool
+{
+    TabuParameters &tabu = configuration.dtss.tabu;
+    bool valid = false;
+    if (name == "dtss.elite_size")
+    {
+        valid = parse(value, configuration.dtss.elite_size, [](unsigned size)
+                      { return size > 0; });
+    }
+    else if (name == "dtss.pick_fraction")
+    {
+        valid = parse(value, configuration.dtss.pick_fraction, is_fraction);
+    }
+    else if (name == "msts.alpha")
+    {
+        valid = parse(value, configuration.msts.alpha, is_fraction);
+    }
+    else if (name == "msts.lambda")
+    {
+        valid = parse(value, configuration.msts.lambda, [](double lambda)
+                      { return lambda >= 0; });
+    }
+    else if (name == "msts.exact_size")
+    {
+        valid = parse(value, configuration.msts.exact_size, [](unsigned size)
+                      { return size <= max_subproblem_size; });
+    }
+    else if (name == "msts.exact_rounds")
+    {
+        valid = parse(value, configuration.msts.exact_rounds);
+    }
+    else if (name == "tabu.adaptive")
+    {
+        valid = parse(value, tabu.adaptive);
+    }
+    else if (name == "tabu.tenure_cap")
+    {
+        valid = parse(value, tabu.tenure_cap);
+    }
+    else if (name == "tabu.tenure_random")
+    {
+        valid = parse(value, tabu.tenure_random, [](unsigned random)
+                      { return random > 0; });
+    }
+    else if (name == "tabu.cutoff")
+    {
+        valid = parse(value, tabu.cutoff);
+    }
+    else if (name == "tabu.pair_moves")
+    {
+        valid = parse(value, tabu.pair_moves);
+    }
+    else if (name == "sa.initial_temperature")
+    {
+        // 0 picks the temperature from the instance size
+        valid = parse(value, configuration.sa.initial_temperature, [](double temperature)
+                      { return temperature >= 0; });
+    }
+    else if (name == "sa.cooling_factor")
+    {
+        valid = parse(value, configuration.sa.cooling_factor, [](double factor)
+                      { return factor > 0 && factor < 1; });
+    }
+    else if (name == "sa.anneal_count")
+    {
+        valid = parse(value, configuration.sa.anneal_count);
+    }
+    else if (name == "sa.restart_factor")
+    {
+        valid = parse(value, configuration.sa.restart_factor, [](double factor)
+                      { return factor > 0; });
+    }
+    else if (name == "sa.run_count")
+    {
+        valid = parse(value, configuration.sa.run_count);
+    }
+    // DTSS and MSTS share one tabu policy setting
+    configuration.msts.tabu = tabu;
+    return valid;
+}
+auto get_parameter(SolverConfiguration const &configuration, std::string const &name) -> std::string
+{
+    TabuParameters const &tabu = configuration.dtss.tabu;
+    if (name == "dtss.elite_size")
+    {
+        return format(configuration.dtss.elite_size);
+    }
+    if (name == "dtss.pick_fraction")
+    {
+        return format(configuration.dtss.pick_fraction);
+    }
+    if (name == "msts.alpha")
+    {
+        return format(configuration.msts.alpha);
+    }
+    if (name == "msts.lambda")
+    {
+        return format(configuration.msts.lambda);
+    }
+    if (name == "msts.exact_size")
+    {
+        return format(configuration.msts.exact_size);
+    }
+    if (name == "msts.exact_rounds")
+    {
+        return format(configuration.msts.exact_rounds);
+    }
+    if (name == "tabu.adaptive")
+    {
+        return format(tabu.adaptive);
+    }
+    if (name == "tabu.tenure_cap")
+    {
+        return format(tabu.tenure_cap);
+    }
+    if (name == "tabu.tenure_random")
+    {
+        return format(tabu.tenure_random);
+    }
+    if (name == "tabu.cutoff")
+    {
+        return format(tabu.cutoff);
+    }
+    if (name == "tabu.pair_moves")
+    {
+        return format(tabu.pair_moves);
+    }
+    if (name == "sa.initial_temperature")
+    {
+        return format(configuration.sa.initial_temperature);
+    }
+    if (name == "sa.cooling_factor")
+    {
+        return format(configuration.sa.cooling_factor);
+    }
+    if (name == "sa.anneal_count")
+    {
+        return format(configuration.sa.anneal_count);
+    }
+    if (name == "sa.restart_factor")
+    {
+        return format(configuration.sa.restart_factor);
+    }
+    if (name == "sa.run_count")
+    {
+        return format(configuration.sa.run_count);
+    }
+    return "";
+}
+auto describe(SolverConfiguration const &configuration) -> std::string
+{
+    // only the parameters the configured solver reads
+    std::vector<std::string> prefixes{"dtss.", "tabu."};
+    if (configuration.solver == "MSTS")
+    {
+        prefixes = {"msts.", "tabu."};
+    }
+    else if (configuration.solver == "SA" || configuration.solver == "MSA")
+    {
+        prefixes = {"sa."};
+    }
+    std::string description;
+    for (auto const &name : parameter_names())
+    {
+        for (auto const &prefix : prefixes)
+        {
+            if (name.compare(0, prefix.size(), prefix) == 0)
+            {
+                description += (description.empty() ? "" : " ") + name + "=" + get_parameter(configuration, name);
+            }
+        }
+    }
+    return description;
+}
+
+auto instance_class(Matrix const &matrix) -> std::string
+{
+    SparseMatrix sparse(matrix);
+    double size = sparse.size();
+    double density = size > 1 ? sparse.nonzero() / (size * (size - 1)) : 0;
+    std::string size_class = size <= 200 ? "small" : size <= 2000 ? "medium"
+                                                                   : "large";
+    return size_class + (density >= 0.1 ? "-dense" : "-sparse");
+}
+
+auto read_configurations(std::string const &path) -> std::map<std::string, SolverConfiguration>
+{
+    std::map<std::string, SolverConfiguration> configurations;
+    std::ifstream input_file(path);
+    std::string line;
+    unsigned line_number = 0;
+    while (std::getline(input_file, line))
+    {
+        line_number++;
+        std::istringstream stream(line);
+        std::string class_name;
+        SolverConfiguration configuration;
+        if (!(stream >> class_name) || class_name[0] == '#' || !(stream >> configuration.solver))
+        {
+            continue;
+        }
+        std::string assignment;
+        while (stream >> assignment)
+        {
+            auto separator = assignment.find('=');
+            if (separator == std::string::npos ||
+                !set_parameter(configuration, assignment.substr(0, separator), assignment.substr(separator + 1)))
+            {
+                std::cerr << path << ":" << line_number << ": ignoring " << assignment << std::endl;
+            }
+        }
+        configurations[class_name + " " + configuration.solver] = configuration;
+    }
+    return configurations;
+}
+auto write_configurations(std::string const &path, std::map<std::string, SolverConfiguration> const &configurations) -> bool
+{
+    std::ofstream output_file(path);
+    output_file << "# {instance class} {solver} {parameter}={value} ...\n";
+    for (auto const &[key, configuration] : configurations)
+    {
+        output_file << key << " " << describe(configuration) << "\n";
+    }
+    output_file.close();
+    return bool(output_file);
+}
+
+auto create_heuristic(SolverConfiguration const &configuration, Matrix const &matrix, unsigned seed) -> Heuristic *
+{
+    if (configuration.solver == "DTSS")
+    {
+        DTSSearch *search = new DTSSearch{matrix, matrix.size(), seed};
+        search->set_parameters(configuration.dtss);
+        return search;
+    }
+    if (configuration.solver == "MSTS")
+    {
+        MSTSearch *search = new MSTSearch{matrix, matrix.size(), seed};
+        search->set_parameters(configuration.msts);
+        return search;
+    }
+    if (configuration.solver == "MSA")
+    {
+        if (MultiSpinAnneal::integer_scale(SparseMatrix(matrix)) != 0)
+        {
+            MultiSpinAnneal *search = new MultiSpinAnneal{matrix, matrix.size(), seed};
+            search->set_parameters(configuration.sa);
+            return search;
+        }
+        std::cout << "MSA needs integer coefficients, using SA" << std::endl;
+    }
+    if (configuration.solver == "SA" || configuration.solver == "MSA")
+    {
+        SimAnneal *search = new SimAnneal{matrix, matrix.size(), seed};
+        search->set_parameters(configuration.sa);
+        return search;
+    }
+    return nullptr;
+}
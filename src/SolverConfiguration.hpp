@@ -0,0 +1,53 @@
+/**
+ * @file SolverConfiguration.hpp
+ * @author Gennesaret Tjusila
+ * @brief Solver parameter sets per instance class and their configuration file
+ */
+#ifndef SolverConfiguration_H
+#define SolverConfiguration_H
+#include "DTSSearch.hpp"
+#include "Heuristic.hpp"
+#include "Matrix.hpp"
+#include "MSTSearch.hpp"
+#include "SimAnneal.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+/// @brief A solver and all of its tunable parameters
+struct SolverConfiguration
+{
+    std::string solver = "DTSS";
+    DTSSParameters dtss;
+    MSTSParameters msts;
+    SAParameters sa;
+};
+
+/// @brief Names of the tunable parameters, as used in configuration files
+std::vector<std::string> parameter_names();
+/// @brief Set a parameter by name, tabu.* keys apply to DTSS and MSTS
+/// @return False if the name or value is invalid
+bool set_parameter(SolverConfiguration &configuration, std::string const &name, std::string const &value);
+/// @brief Get a parameter by name
+std::string get_parameter(SolverConfiguration const &configuration, std::string const &name);
+/// @brief Space separated name=value list of the parameters of the configured solver
+std::string describe(SolverConfiguration const &configuration);
+
+/// @brief Coarse instance class used to look up tuned parameters
+/// @return "{small|medium|large}-{sparse|dense}"
+std::string instance_class(Matrix const &matrix);
+
+/// @brief Read a configuration file, one "{class} {solver} name=value ..." line per entry
+/// @return Configurations keyed by "{class} {solver}", empty if the file does not exist
+std::map<std::string, SolverConfiguration> read_configurations(std::string const &path);
+/// @brief Write configurations in the format of read_configurations
+/// @return False if the file could not be written
+bool write_configurations(std::string const &path, std::map<std::string, SolverConfiguration> const &configurations);
+
+/// @brief Create the configured solver
+/// @param configuration Solver and parameters
+/// @param matrix Q matrix
+/// @param seed RNG seed
+/// @return New solver, nullptr for an unknown solver name
+Heuristic *create_heuristic(SolverConfiguration const &configuration, Matrix const &matrix, unsigned seed);
+#endif
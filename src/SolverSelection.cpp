@@ -0,0 +1,156 @@
+#include "SolverSelection.hpp"
+#include "InstanceFeatures.hpp"
+#include "SolverConfiguration.hpp"
+#include "SparseMatrix.hpp"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /// @brief Parse one rule line
+    /// @return False if the line is not a valid rule
+    auto parse_rule(std::string const &line, SelectionRule &rule) -> bool
+    {
+        std::istringstream stream(line);
+        std::string token;
+        while (stream >> token && token != "->")
+        {
+            auto position = token.find_first_of("<=>");
+            if (position == std::string::npos || position == 0)
+            {
+                return false;
+            }
+            FeatureCondition condition;
+            condition.feature = token.substr(0, position);
+            auto value_position = token.find_first_not_of("<=>", position);
+            condition.comparison = token.substr(position, value_position - position);
+            bool known;
+            get_feature(InstanceFeatures{}, condition.feature, known);
+            std::istringstream value(value_position == std::string::npos ? "" : token.substr(value_position));
+            if (!known || !(value >> condition.value) ||
+                (condition.comparison != "<" && condition.comparison != "<=" && condition.comparison != "==" &&
+                 condition.comparison != ">=" && condition.comparison != ">"))
+            {
+                return false;
+            }
+            rule.conditions.push_back(condition);
+        }
+        if (token != "->" || !(stream >> rule.configuration.solver))
+        {
+            return false;
+        }
+        while (stream >> token)
+        {
+            auto separator = token.find('=');
+            if (separator == std::string::npos ||
+                !set_parameter(rule.configuration, token.substr(0, separator), token.substr(separator + 1)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto holds(FeatureCondition const &condition, InstanceFeatures const &features) -> bool
+    {
+        bool known;
+        double value = get_feature(features, condition.feature, known);
+        if (condition.comparison == "<")
+        {
+            return value < condition.value;
+        }
+        if (condition.comparison == "<=")
+        {
+            return value <= condition.value;
+        }
+        if (condition.comparison == "==")
+        {
+            return value == condition.value;
+        }
+        if (condition.comparison == ">=")
+        {
+            return value >= condition.value;
+        }
+        return value > condition.value;
+    }
+}
+
+auto default_selection_rules() -> std::vector<SelectionRule>
+{
+    // sparse instances profit from the neighbour-only updates of MSTS, dense ones from the full scans of DTSS
+    std::vector<std::string> lines{"density<0.02 -> MSTS",
+                                   "-> DTSS"};
+    std::vector<SelectionRule> rules;
+    for (auto const &line : lines)
+    {
+        SelectionRule rule;
+        parse_rule(line, rule);
+        rules.push_back(rule);
+    }
+    return rules;
+}
+auto read_selection_rules(std::string const &path) -> std::vector<SelectionRule>
+{
+    std::vector<SelectionRule> rules;
+    std::ifstream input_file(path);
+    std::string line;
+    unsigned line_number = 0;
+    while (std::getline(input_file, line))
+    {
+        line_number++;
+        if (line.find_first_not_of(" \t") == std::string::npos || line[line.find_first_not_of(" \t")] == '#')
+        {
+            continue;
+        }
+        SelectionRule rule;
+        if (!parse_rule(line, rule))
+        {
+            std::cerr << path << ":" << line_number << ": ignoring invalid rule" << std::endl;
+            continue;
+        }
+        rules.push_back(rule);
+    }
+    return rules;
+}
+auto select_solver(InstanceFeatures const &features, std::vector<SelectionRule> const &rules) -> SolverConfiguration
+{
+    for (auto const &rule : rules)
+    {
+        bool match = true;
+        for (auto const &condition : rule.conditions)
+        {
+            match = match && holds(condition, features);
+        }
+        if (match)
+        {
+            return rule.configuration;
+        }
+    }
+    return SolverConfiguration{};
+}
+auto configure_solver(std::string const &solver, Matrix const &matrix, std::vector<SelectionRule> const &rules,
+                      std::map<std::string, SolverConfiguration> const &configurations,
+                      std::vector<std::pair<std::string, std::string>> const &parameters) -> SolverConfiguration
+{
+    SolverConfiguration configuration;
+    configuration.solver = solver;
+    if (solver == "AUTO")
+    {
+        configuration = select_solver(extract_features(SparseMatrix(matrix)), rules);
+    }
+    auto tuned = configurations.find(instance_class(matrix) + " " + configuration.solver);
+    if (tuned != configurations.end())
+    {
+        configuration = tuned->second;
+    }
+    for (auto const &[name, value] : parameters)
+    {
+        set_parameter(configuration, name, value);
+    }
+    return configuration;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file SolverSelection.hpp
+ * @author Gennesaret Tjusila
+ * @brief Rules table that picks a solver and parameters from instance features
+ */
+#ifndef SolverSelection_H
+#define SolverSelection_H
+#include "InstanceFeatures.hpp"
+#include "SolverConfiguration.hpp"
+#include "Matrix.hpp"
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief A feature comparison such as density<0.1
+struct FeatureCondition
+{
+    std::string feature;
+    std::string comparison;
+    double value;
+};
+
+/// @brief Solver and parameters used when all conditions hold
+struct SelectionRule
+{
+    std::vector<FeatureCondition> conditions;
+    SolverConfiguration configuration;
+};
+
+/// @brief Built-in rules, used without a rules file
+std::vector<SelectionRule> default_selection_rules();
+/// @brief Read a rules file, one "{feature}{<,<=,==,>=,>}{value} ... -> {solver} {parameter}={value} ..." line per rule
+/// @return Rules in file order, empty if the file does not exist
+std::vector<SelectionRule> read_selection_rules(std::string const &path);
+/// @brief Configuration of the first rule whose conditions all hold
+/// @return The DTSS defaults if no rule matches
+SolverConfiguration select_solver(InstanceFeatures const &features, std::vector<SelectionRule> const &rules);
+/// @brief Configuration of a run: the rules for AUTO, then the tuned entry of the instance class, then explicit parameters
+/// @param solver Solver name or AUTO
+/// @param matrix Q matrix of the instance
+/// @param rules Selection rules of AUTO
+/// @param configurations Tuned configurations as returned by read_configurations
+/// @param parameters Parameters given by name
+SolverConfiguration configure_solver(std::string const &solver, Matrix const &matrix, std::vector<SelectionRule> const &rules,
+                                     std::map<std::string, SolverConfiguration> const &configurations,
+                                     std::vector<std::pair<std::string, std::string>> const &parameters);
+#endif
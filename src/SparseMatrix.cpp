@@ -0,0 +1,80 @@
+#include "SparseMatrix.hpp"
+#include "Matrix.hpp"
+#include <algorithm>
+#include <vector>
+
+SparseMatrix::SparseMatrix(Matrix const &matrix)
+    : _size{matrix.size()},
+      _nonzero{0},
+      _diagonal(matrix.size(), 0),
+      _row_start(matrix.size() + 1, 0),
+      _row_length(matrix.size(), 0),
+      _row_capacity(),
+      _entries()
+{
+    // count the neighbours of every variable first so each row is a single slice
+    for (unsigned i = 0; i < _size; i++)
+    {
+        _diagonal[i] = matrix(i, i);
+        matrix.for_each_lower(i, [this, i](unsigned j, double)
+                              {
+                                  _row_length[i]++;
+                                  _row_length[j]++; });
+    }
+    for (unsigned i = 0; i < _size; i++)
+    {
+        _row_start[i + 1] = _row_start[i] + _row_length[i];
+    }
+    _row_capacity = _row_length;
+    _nonzero = _row_start[_size];
+    _entries.resize(_nonzero);
+    std::vector<unsigned> fill(_row_start.begin(), _row_start.end() - 1);
+    for (unsigned i = 0; i < _size; i++)
+    {
+        matrix.for_each_lower(i, [this, i, &fill](unsigned j, double value)
+                              {
+                                  _entries[fill[i]++] = Entry{j, value};
+                                  _entries[fill[j]++] = Entry{i, value}; });
+    }
+}
+SparseMatrix::SparseMatrix() : _size{0}, _nonzero{0}, _diagonal{}, _row_start(1, 0), _row_length{}, _row_capacity{}, _entries{} {};
+auto SparseMatrix::add(unsigned row, unsigned column, double delta) -> void
+{
+    if (row == column)
+    {
+        _diagonal[row] += delta;
+        return;
+    }
+    this->_add_entry(row, column, delta);
+    this->_add_entry(column, row, delta);
+}
+auto SparseMatrix::_add_entry(unsigned row, unsigned column, double delta) -> void
+{
+    Entry *first = _entries.data() + _row_start[row];
+    Entry *last = first + _row_length[row];
+    Entry *entry = std::find_if(first, last, [column](Entry const &e)
+                                { return e.column == column; });
+    if (entry != last)
+    {
+        entry->value += delta;
+        if (entry->value == 0)
+        {
+            *entry = *(last - 1);
+            _row_length[row]--;
+            _nonzero--;
+        }
+        return;
+    }
+    if (_row_length[row] == _row_capacity[row])
+    {
+        // move a full row to the end of the entries with twice the room, its old slot is left unused
+        unsigned start = _entries.size();
+        _row_capacity[row] = std::max(4u, 2 * _row_capacity[row]);
+        _entries.resize(start + _row_capacity[row]);
+        std::copy(_entries.begin() + _row_start[row], _entries.begin() + _row_start[row] + _row_length[row], _entries.begin() + start);
+        _row_start[row] = start;
+    }
+    _entries[_row_start[row] + _row_length[row]] = Entry{column, delta};
+    _row_length[row]++;
+    _nonzero++;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file SparseMatrix.hpp
+ * @author Gennesaret Tjusila
+ * @brief Compressed sparse row view of the off-diagonal entries of a Q matrix
+ */
+#ifndef SparseMatrix_H
+#define SparseMatrix_H
+#include "Matrix.hpp"
+#include "Placement.hpp"
+#include <vector>
+
+/// @brief Symmetric neighbour lists of a lower triangular Q matrix
+class SparseMatrix
+{
+public:
+    /// @brief An off-diagonal nonzero Q(i, j) seen from row i
+    struct Entry
+    {
+        unsigned column;
+        double value;
+    };
+    /// @brief Build the neighbour lists of a Q matrix
+    /// @param matrix Lower triangular Q matrix
+    SparseMatrix(Matrix const &matrix);
+    SparseMatrix();
+    unsigned size() const
+    {
+        return _size;
+    }
+    /// @brief Number of stored entries (each off-diagonal term is stored twice)
+    unsigned nonzero() const
+    {
+        return _nonzero;
+    }
+    double diagonal(unsigned row) const
+    {
+        return _diagonal[row];
+    }
+    /// @brief First neighbour of a variable
+    Entry const *begin(unsigned row) const
+    {
+        return _entries.data() + _row_start[row];
+    }
+    /// @brief One past the last neighbour of a variable
+    Entry const *end(unsigned row) const
+    {
+        return _entries.data() + _row_start[row] + _row_length[row];
+    }
+    /// @brief Add to a coefficient in O(degree), a term that becomes 0 is removed
+    /// @param row Row index
+    /// @param column Column index
+    /// @param delta Value to add
+    void add(unsigned row, unsigned column, double delta);
+
+private:
+    unsigned _size;
+    unsigned _nonzero;
+    std::vector<double> _diagonal;
+    // rows may have spare capacity after edits, so they carry their own length
+    std::vector<unsigned> _row_start;
+    std::vector<unsigned> _row_length;
+    std::vector<unsigned> _row_capacity;
+    std::vector<Entry, HugePageAllocator<Entry>> _entries;
+    void _add_entry(unsigned row, unsigned column, double delta);
+};
+#endif
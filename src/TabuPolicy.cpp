@@ -0,0 +1,100 @@
+#include "TabuPolicy.hpp"
+#include "Checkpoint.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+TabuPolicy::TabuPolicy(unsigned size, TabuParameters const &parameters)
+    : _size{size},
+      _parameters{parameters},
+      _keys(),
+      _visited(),
+      _hash{0},
+      _tenure{double(std::min(parameters.tenure_cap, size / 4))},
+      _max_tenure{std::max(1u, (std::max(size, 1u) - 1) / (parameters.pair_moves ? 2 : 1))},
+      _cycle_length{double(size)},
+      _last_tenure_change{0},
+      _cutoff{parameters.cutoff},
+      _last_improvement{0},
+      _longest_gap{0}
+{
+    if (_parameters.adaptive)
+    {
+        // fixed keys so the hash does not draw from the solver's random engine
+        std::mt19937_64 key_engine(size);
+        _keys.resize(size);
+        for (auto &key : _keys)
+        {
+            key = key_engine();
+        }
+    }
+}
+TabuPolicy::TabuPolicy(unsigned size) : TabuPolicy(size, TabuParameters{}) {}
+
+auto TabuPolicy::begin() -> void
+{
+    _visited.clear();
+    _hash = 0;
+    _last_tenure_change = 0;
+    _last_improvement = 0;
+    _longest_gap = 0;
+}
+auto TabuPolicy::tenure(std::mt19937 &random_engine) -> unsigned
+{
+    std::uniform_int_distribution<std::mt19937::result_type> random_part(1, _parameters.tenure_random);
+    return std::min<unsigned>(unsigned(_tenure + 0.5) + random_part(random_engine), _max_tenure);
+}
+auto TabuPolicy::flip(unsigned variable, unsigned iteration) -> void
+{
+    if (!_parameters.adaptive)
+    {
+        return;
+    }
+    _hash ^= _keys[variable];
+    auto visit = _visited.find(_hash);
+    if (visit != _visited.end())
+    {
+        // a solution came back, lengthen the tenure
+        _cycle_length = 0.9 * _cycle_length + 0.1 * (iteration - visit->second);
+        _tenure = std::min(1.1 * _tenure + 1, std::max(1.0, double(_max_tenure) - _parameters.tenure_random));
+        _last_tenure_change = iteration;
+        visit->second = iteration;
+        return;
+    }
+    _visited.emplace(_hash, iteration);
+    if (iteration - _last_tenure_change > _cycle_length)
+    {
+        // no cycle for longer than a typical one, shorten the tenure
+        _tenure = std::max(0.9 * _tenure, 1.0);
+        _last_tenure_change = iteration;
+    }
+}
+auto TabuPolicy::improved(unsigned iteration) -> void
+{
+    _longest_gap = std::max(_longest_gap, iteration - _last_improvement);
+    _last_improvement = iteration;
+}
+auto TabuPolicy::end() -> void
+{
+    if (!_parameters.adaptive)
+    {
+        return;
+    }
+    // the final gap always equals the cutoff, so only the gaps that ended in an improvement count
+    double cutoff = _parameters.cutoff_factor * std::max(_longest_gap, 1u);
+    _cutoff = unsigned(std::clamp(cutoff, double(_parameters.cutoff_min), double(_parameters.cutoff_max)));
+}
+auto TabuPolicy::save(std::ostream &stream) const -> void
+{
+    write_value<double>(stream, _tenure);
+    write_value<double>(stream, _cycle_length);
+    write_value<unsigned>(stream, _cutoff);
+}
+auto TabuPolicy::load(std::istream &stream) -> void
+{
+    _tenure = read_value<double>(stream);
+    _cycle_length = read_value<double>(stream);
+    _cutoff = read_value<unsigned>(stream);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file TabuPolicy.hpp
+ * @author Gennesaret Tjusila
+ * @brief Tabu tenure and improvement cutoff of the tabu searches, fixed or adapted online
+ */
+#ifndef TabuPolicy_H
+#define TabuPolicy_H
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Parameters of a TabuPolicy
+struct TabuParameters
+{
+    /// @brief Adapt tenure and cutoff instead of using the fixed rule
+    bool adaptive = false;
+    /// @brief Fixed tenure min(tenure_cap, n / 4) + U[1, tenure_random]
+    unsigned tenure_cap = 20;
+    unsigned tenure_random = 10;
+    /// @brief Non-improving iterations before a tabu search ends, the initial value when adaptive
+    unsigned cutoff = 10000;
+    /// @brief Adaptive cutoff bounds
+    unsigned cutoff_min = 500;
+    unsigned cutoff_max = 50000;
+    /// @brief Adaptive cutoff as a multiple of the longest gap between improvements of the last search
+    double cutoff_factor = 4;
+    /// @brief Try two-flip moves over interacting pairs when no single flip improves
+    bool pair_moves = false;
+};
+
+/// @brief Tenure and stopping rule of one tabu search after another
+///
+/// The adaptive policy follows reactive tabu search: a hash of every visited solution is kept,
+/// revisiting one means the search cycles and the tenure grows, a long stretch without
+/// revisits shrinks it again. The cutoff of the next search is scaled to how far apart the
+/// improvements of the last search were.
+class TabuPolicy
+{
+public:
+    /// @brief Create a policy
+    /// @param size Problem size
+    /// @param parameters Policy parameters
+    TabuPolicy(unsigned size, TabuParameters const &parameters);
+    TabuPolicy(unsigned size);
+    TabuParameters const &parameters() const
+    {
+        return _parameters;
+    }
+    /// @brief Start a tabu search, forgets the visited solutions of the last one
+    void begin();
+    /// @brief Tenure of a variable that was just flipped, below the number of flips that would leave every variable tabu
+    unsigned tenure(std::mt19937 &random_engine);
+    /// @brief Record a flip, detects cycling when adaptive
+    /// @param variable Flipped variable
+    /// @param iteration Current iteration
+    void flip(unsigned variable, unsigned iteration);
+    /// @brief Record a new best solution of the current search
+    void improved(unsigned iteration);
+    /// @brief Check if the current search continues
+    bool proceed(unsigned iteration) const
+    {
+        return iteration <= _last_improvement + _cutoff;
+    }
+    /// @brief End a tabu search, adapts the cutoff of the next one
+    void end();
+    unsigned cutoff() const
+    {
+        return _cutoff;
+    }
+    /// @brief Write the adapted tenure and cutoff
+    void save(std::ostream &stream) const;
+    /// @brief Restore the adapted tenure and cutoff
+    void load(std::istream &stream);
+
+private:
+    unsigned _size;
+    TabuParameters _parameters;
+    std::vector<std::uint64_t> _keys;
+    std::unordered_map<std::uint64_t, unsigned> _visited;
+    std::uint64_t _hash;
+    double _tenure;
+    // longest tenure, one or two flips per iteration must leave a variable free
+    unsigned _max_tenure;
+    double _cycle_length;
+    unsigned _last_tenure_change;
+    unsigned _cutoff;
+    unsigned _last_improvement;
+    unsigned _longest_gap;
+};
+#endif
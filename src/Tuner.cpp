@@ -0,0 +1,225 @@
+#include "Tuner.hpp"
+#include "Evaluator.hpp"
+#include "Heuristic.hpp"
+#include "Matrix.hpp"
+#include "read_file.hpp"
+#include "SolverConfiguration.hpp"
+#include "SparseMatrix.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// @brief Sampling range of a tunable parameter
+    struct ParameterRange
+    {
+        std::string name;
+        double low;
+        double high;
+        bool integer;
+        bool logarithmic;
+    };
+
+    auto parameter_ranges(std::string const &solver, unsigned size) -> std::vector<ParameterRange>
+    {
+        std::vector<ParameterRange> tabu{{"tabu.adaptive", 0, 1, true, false},
+                                         {"tabu.tenure_cap", 5, 40, true, false},
+                                         {"tabu.tenure_random", 1, 20, true, false},
+                                         {"tabu.cutoff", 1000, 20000, true, true},
+                                         {"tabu.pair_moves", 0, 1, true, false}};
+        std::vector<ParameterRange> ranges;
+        if (solver == "DTSS")
+        {
+            ranges = {{"dtss.elite_size", 5, 40, true, false},
+                      {"dtss.pick_fraction", 0.02, 0.3, false, true}};
+        }
+        else if (solver == "MSTS")
+        {
+            ranges = {{"msts.alpha", 0.1, 0.8, false, false},
+                      {"msts.lambda", 100, 20000, false, true},
+                      {"msts.exact_size", 0, 24, true, false}};
+        }
+        else
+        {
+            return {{"sa.initial_temperature", 0.01 * size, 1.0 * size, false, true},
+                    {"sa.cooling_factor", 0.9, 0.999, false, false},
+                    {"sa.anneal_count", 5, 50, true, false},
+                    {"sa.restart_factor", 0.9, 1, false, false}};
+        }
+        ranges.insert(ranges.end(), tabu.begin(), tabu.end());
+        return ranges;
+    }
+
+    auto sample_configuration(std::string const &solver, unsigned size, std::mt19937 &random_engine) -> SolverConfiguration
+    {
+        SolverConfiguration configuration;
+        configuration.solver = solver;
+        std::uniform_real_distribution<double> uniform(0, 1);
+        for (auto const &range : parameter_ranges(solver, size))
+        {
+            double low = range.logarithmic ? std::log(range.low) : range.low;
+            double high = range.logarithmic ? std::log(range.high) : range.high;
+            double value = low + uniform(random_engine) * (high - low);
+            value = range.logarithmic ? std::exp(value) : value;
+            std::ostringstream text;
+            if (range.integer)
+            {
+                text << std::lround(value);
+            }
+            else
+            {
+                text << value;
+            }
+            set_parameter(configuration, range.name, text.str());
+        }
+        return configuration;
+    }
+
+    /// @brief Run every configuration on every instance of a class on a pool of threads
+    /// @return Objective values indexed by configuration, then instance
+    auto race(std::vector<SolverConfiguration> const &configurations, std::vector<Matrix> const &matrices,
+              std::vector<SparseMatrix> const &sparse, unsigned seconds, unsigned threads, unsigned seed)
+        -> std::vector<std::vector<double>>
+    {
+        std::vector<std::vector<double>> values(configurations.size(), std::vector<double>(matrices.size(), 0));
+        unsigned job_count = configurations.size() * matrices.size();
+        std::atomic<unsigned> next_job{0};
+        auto worker = [&]()
+        {
+            for (unsigned job = next_job++; job < job_count; job = next_job++)
+            {
+                unsigned configuration = job / matrices.size();
+                unsigned instance = job % matrices.size();
+                Heuristic *heuristic = create_heuristic(configurations[configuration], matrices[instance], seed + instance);
+                heuristic->solve(seconds);
+                values[configuration][instance] = evaluate(sparse[instance], heuristic->get_solution());
+                delete heuristic;
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned thread = 0; thread < std::max(1u, std::min(threads, job_count)); thread++)
+        {
+            pool.emplace_back(worker);
+        }
+        for (auto &thread : pool)
+        {
+            thread.join();
+        }
+        return values;
+    }
+
+    /// @brief Mean over the instances of the objective scaled to [0, 1] between the worst and best configuration
+    auto normalised_scores(std::vector<std::vector<double>> const &values) -> std::vector<double>
+    {
+        std::vector<double> scores(values.size(), 0);
+        for (unsigned instance = 0; instance < values[0].size(); instance++)
+        {
+            double best = values[0][instance];
+            double worst = values[0][instance];
+            for (auto const &row : values)
+            {
+                best = std::max(best, row[instance]);
+                worst = std::min(worst, row[instance]);
+            }
+            for (unsigned configuration = 0; configuration < values.size(); configuration++)
+            {
+                double value = values[configuration][instance];
+                scores[configuration] += best > worst ? (value - worst) / (best - worst) : 1;
+            }
+        }
+        for (auto &score : scores)
+        {
+            score /= values[0].size();
+        }
+        return scores;
+    }
+}
+
+auto run_tuning(TuningOptions const &options) -> bool
+{
+    namespace fs = std::filesystem;
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (fs::recursive_directory_iterator entry(options.instance_directory, error), end; !error && entry != end; entry.increment(error))
+    {
+        if (entry->is_regular_file() && entry->path().extension() == ".qs")
+        {
+            paths.push_back(entry->path().string());
+        }
+    }
+    if (paths.empty())
+    {
+        std::cout << "No .qs instances found in " << options.instance_directory << std::endl;
+        return false;
+    }
+    std::sort(paths.begin(), paths.end());
+    // classify first so only the instances of one class are held in memory at a time
+    std::map<std::string, std::vector<std::string>> classes;
+    for (auto const &path : paths)
+    {
+        Matrix matrix = read_file_test(path);
+        if (matrix.size() == 0)
+        {
+            std::cout << "Skipping " << path << ", not a QPLIB instance" << std::endl;
+            continue;
+        }
+        classes[instance_class(matrix)].push_back(path);
+    }
+
+    std::mt19937 random_engine(options.seed);
+    std::map<std::string, SolverConfiguration> configurations = read_configurations(options.output_path);
+    for (auto const &[class_name, class_paths] : classes)
+    {
+        std::vector<Matrix> matrices;
+        std::vector<SparseMatrix> sparse;
+        unsigned largest = 0;
+        for (auto const &path : class_paths)
+        {
+            matrices.push_back(read_file_test(path));
+            sparse.emplace_back(matrices.back());
+            largest = std::max(largest, matrices.back().size());
+        }
+        std::vector<SolverConfiguration> candidates(1);
+        candidates[0].solver = options.solver;
+        while (candidates.size() < std::max(1u, options.candidates))
+        {
+            candidates.push_back(sample_configuration(options.solver, largest, random_engine));
+        }
+        unsigned seconds = std::max(1u, options.seconds);
+        for (unsigned round = 1; candidates.size() > 1; round++)
+        {
+            std::cout << class_name << " round " << round << ": " << candidates.size() << " configurations, "
+                      << class_paths.size() << " instances, " << seconds << "s each" << std::endl;
+            std::vector<double> scores = normalised_scores(race(candidates, matrices, sparse, seconds, options.threads, options.seed));
+            std::vector<unsigned> order(candidates.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&scores](unsigned a, unsigned b)
+                             { return scores[a] > scores[b]; });
+            std::vector<SolverConfiguration> survivors;
+            for (unsigned rank = 0; rank < (candidates.size() + 1) / 2; rank++)
+            {
+                survivors.push_back(candidates[order[rank]]);
+            }
+            candidates.swap(survivors);
+            seconds *= 2;
+        }
+        std::cout << class_name << " " << options.solver << " " << describe(candidates[0]) << std::endl;
+        configurations[class_name + " " + options.solver] = candidates[0];
+    }
+    if (!write_configurations(options.output_path, configurations))
+    {
+        std::cout << "Could not write " << options.output_path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file Tuner.hpp
+ * @author Gennesaret Tjusila
+ * @brief Successive halving over solver parameters on an instance corpus
+ */
+#ifndef Tuner_H
+#define Tuner_H
+#include <string>
+
+/// @brief Settings of a tuning run
+struct TuningOptions
+{
+    /// @brief Directory searched recursively for .qs instances
+    std::string instance_directory;
+    /// @brief Solver to tune: DTSS, MSTS or SA
+    std::string solver;
+    /// @brief Configuration file the best parameters are merged into
+    std::string output_path;
+    /// @brief Seconds per solve in the first round, doubled every round
+    unsigned seconds = 1;
+    /// @brief Solves run at the same time
+    unsigned threads = 1;
+    /// @brief Configurations of the first round, the default parameters are one of them
+    unsigned candidates = 16;
+    /// @brief Seed of the sampled configurations and of the solvers
+    unsigned seed = 1;
+};
+
+/// @brief Tune the parameters of a solver per instance class
+///
+/// The instances are grouped by instance_class. For every class, randomly sampled
+/// configurations solve all instances of the class, and the better half by mean
+/// normalised objective survives into the next round with twice the time, until one is left.
+/// @param options Tuning settings
+/// @return False if no instance was found or the configuration file could not be written
+bool run_tuning(TuningOptions const &options);
+#endif
@@ -0,0 +1,46 @@
+#include "WeightedSampler.hpp"
+#include "FenwickTree.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+WeightedSampler::WeightedSampler(std::vector<double> const &weights)
+    : _tree(weights),
+      _removed(weights.size(), false),
+      _remaining(weights.size()) {}
+auto WeightedSampler::sample(std::mt19937 &random_engine) -> unsigned
+{
+    if (_remaining == 0)
+    {
+        return _removed.size();
+    }
+    unsigned index = 0;
+    if (_tree.total() > 0)
+    {
+        std::uniform_real_distribution<double> roll(0, _tree.total());
+        index = _tree.find(roll(random_engine));
+    }
+    // only zero weights (or rounding leftovers of removed ones) remain, take the next free index
+    while (_removed[index])
+    {
+        index = (index + 1) % _removed.size();
+    }
+    this->remove(index);
+    return index;
+}
+auto WeightedSampler::remove(unsigned index) -> void
+{
+    if (_removed[index])
+    {
+        return;
+    }
+    _tree.add(index, -_tree.value(index));
+    _removed[index] = true;
+    _remaining--;
+}
+auto WeightedSampler::reset(std::vector<double> const &weights) -> void
+{
+    _tree = FenwickTree(weights);
+    std::fill(_removed.begin(), _removed.end(), false);
+    _remaining = _removed.size();
+}
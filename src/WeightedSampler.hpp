@@ -0,0 +1,40 @@
+/**
+ * @file WeightedSampler.hpp
+ * @author Gennesaret Tjusila
+ * @brief Weighted sampling without replacement on top of a Fenwick tree
+ */
+#ifndef WeightedSampler_H
+#define WeightedSampler_H
+#include "FenwickTree.hpp"
+#include <random>
+#include <vector>
+
+/// @brief Draws indices proportional to their weight, each index at most once
+class WeightedSampler
+{
+public:
+    /// @brief Create a sampler over nonnegative weights in O(n)
+    /// @param weights Weight of every index
+    WeightedSampler(std::vector<double> const &weights);
+    /// @brief Draw an index and remove it from the sampler in O(log n)
+    /// @param random_engine Random engine
+    /// @return Drawn index, the number of weights if no index is left
+    unsigned sample(std::mt19937 &random_engine);
+    /// @brief Remove an index so it can no longer be drawn
+    /// @param index Index to remove
+    void remove(unsigned index);
+    /// @brief Put every index back with a new weight in O(n)
+    /// @param weights Weight of every index, as many as the sampler was created with
+    void reset(std::vector<double> const &weights);
+    /// @brief Number of indices left to draw
+    unsigned remaining() const
+    {
+        return _remaining;
+    }
+
+private:
+    FenwickTree _tree;
+    std::vector<bool> _removed;
+    unsigned _remaining;
+};
+#endif
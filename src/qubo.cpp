@@ -4,17 +4,35 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <numeric>
 #include <random>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "Batch.hpp"
+#include "Checkpoint.hpp"
 #include "DTSSearch.hpp"
+#include "Evaluator.hpp"
 #include "Heuristic.hpp"
+#include "MemoryPlan.hpp"
+#include "InstanceFeatures.hpp"
+#include "Island.hpp"
 #include "read_file.hpp"
 #include "MSTSearch.hpp"
+#include "Options.hpp"
+#include "ParallelSearch.hpp"
+#include "Placement.hpp"
+#include "Reordering.hpp"
+#include "Server.hpp"
 #include "SimAnneal.hpp"
+#include "SolverConfiguration.hpp"
+#include "SolverSelection.hpp"
+#include "SparseMatrix.hpp"
+#include "TabuPolicy.hpp"
+#include "Tuner.hpp"
+#include <thread>
 
 std::vector<std::string> split(std::string s, char delim)
 {
@@ -30,99 +48,342 @@ std::vector<std::string> split(std::string s, char delim)
     return res;
 }
 
-double eval(Matrix &Q, const std::vector<bool> x)
+int main(int argc, char const *argv[])
 {
-    double result = 0;
-    for (unsigned i = 0; i < x.size(); i++)
+    std::chrono::high_resolution_clock::time_point start_time_ms; // Start Time
+    std::chrono::duration<double, std::milli> duration_ms;        // Stop time
+
+    start_time_ms = std::chrono::high_resolution_clock::now();
+    RunOptions options;
+    std::string error;
+    if (!parse_options(argc, argv, options, error))
+    {
+        std::cout << error << "\n\n"
+                  << usage();
+        return 1;
+    }
+    if (options.help || (options.instance.empty() && options.tune_directory.empty() && options.serve_address.empty() && options.batch_directory.empty()))
+    {
+        std::cout << usage();
+        return options.help ? 0 : 1;
+    }
+    if (!options.serve_address.empty())
+    {
+        ServerOptions serving;
+        serving.address = options.serve_address;
+        serving.workers = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        serving.queue_limit = options.queue_limit;
+        serving.cache_size = options.cache_size;
+        serving.time_limit = options.time_limit > 0 ? options.time_limit : 600;
+        serving.configuration_path = options.configuration_path;
+        serving.rules_path = options.rules_path;
+        serving.memory_limit = options.memory_limit > 0 ? options.memory_limit : 1024;
+        serving.instance_root = options.instance_root;
+        return run_server(serving) ? 0 : 1;
+    }
+    if (!options.batch_directory.empty())
+    {
+        BatchOptions batch;
+        batch.instance_directory = options.batch_directory;
+        batch.reference_directory = options.reference_directory;
+        batch.solution_directory = options.solution_path;
+        batch.log_directory = options.log_path;
+        batch.solver = options.solver;
+        batch.seconds = options.time_limit > 0 ? options.time_limit : 600;
+        batch.has_seed = options.has_seed;
+        batch.seed = options.seed;
+        batch.configuration_path = options.configuration_path;
+        batch.rules_path = options.rules_path;
+        batch.parameters = options.parameters;
+        return run_batch(batch) ? 0 : 1;
+    }
+    if (!options.tune_directory.empty())
     {
-        for (unsigned j = 0; j <= i; j++)
+        if (options.configuration_path.empty())
         {
-            if (j < i)
-            {
-                result += x[i] * Q(i, j) * x[j];
-            }
-            else
+            std::cout << "--tune needs --config {file} to write the tuned parameters to" << std::endl;
+            return 1;
+        }
+        TuningOptions tuning;
+        tuning.instance_directory = options.tune_directory;
+        tuning.solver = options.solver;
+        tuning.output_path = options.configuration_path;
+        tuning.seconds = options.time_limit > 0 ? options.time_limit : 1;
+        tuning.threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        tuning.candidates = options.tune_configurations;
+        tuning.seed = options.has_seed ? options.seed : 1;
+        return run_tuning(tuning) ? 0 : 1;
+    }
+    std::string solver = options.solver;
+    unsigned time = options.time_limit > 0 ? options.time_limit : 600;
+    unsigned parallel = options.parallel > 0 ? options.parallel : std::max(1u, std::thread::hardware_concurrency());
+    // every NUMA node that runs a solver thread reads its own copy of Q
+    std::vector<NumaNode> nodes;
+    unsigned replica_count = 0;
+    if (options.numa && parallel > 1)
+    {
+        nodes = numa_nodes();
+        replica_count = nodes.size() > 1 ? std::min<unsigned>(nodes.size(), parallel) : 0;
+    }
+    set_huge_pages(options.huge_pages);
+    // check the footprint before allocating anything of the size of the instance
+    Matrix::Storage storage = Matrix::Storage::dense_double;
+    if (options.memory_limit > 0)
+    {
+        unsigned row_count = 0;
+        unsigned nonlinear_count = 0;
+        if (!read_file_header(options.instance, row_count, nonlinear_count))
+        {
+            std::cout << "Cannot read the header of " << options.instance << std::endl;
+            return 1;
+        }
+        std::size_t limit = std::size_t(options.memory_limit) << 20;
+        auto estimates = estimate_memory(solver, row_count, nonlinear_count);
+        // the solvers may get a reordered copy and NUMA replicas, the original stays for edits and the final evaluation
+        unsigned matrix_copies = 1 + (options.reorder != "none" ? 1 : 0) + replica_count;
+        for (auto &estimate : estimates)
+        {
+            estimate.matrix_bytes *= matrix_copies;
+        }
+        if (!choose_storage(limit, estimates, storage))
+        {
+            std::cout << "No matrix storage fits into " << options.memory_limit << " MiB, estimates:" << std::endl;
+            for (auto const &estimate : estimates)
             {
-                result += x[i] * Q(i, i) * x[j];
+                std::cout << "  " << Matrix::storage_name(estimate.storage) << ": " << (estimate.matrix_bytes >> 20) << " MiB matrix + "
+                          << (estimate.solver_bytes >> 20) << " MiB solver = " << (estimate.total() >> 20) << " MiB" << std::endl;
             }
+            return 1;
         }
+        std::cout << "Using " << Matrix::storage_name(storage) << " matrix storage within " << options.memory_limit << " MiB" << std::endl;
+    }
+    Matrix matrix = read_file_test(options.instance, storage); // read matrix from QPLIB
+    if (matrix.size() == 0)
+    {
+        std::cout << options.instance << " is not a QPLIB instance" << std::endl;
+        return 1;
+    }
+    if (matrix.rounded())
+    {
+        std::cout << "Some coefficients were rounded to float" << std::endl;
     }
-    return result;
-}
-int main(int argc, char const *argv[])
-{
-    std::chrono::high_resolution_clock::time_point start_time_ms; // Start Time
-    std::chrono::duration<double, std::milli> duration_ms;        // Stop time
 
-    start_time_ms = std::chrono::high_resolution_clock::now();
-    if (argc < 2)
+    // the reference solution is optional
+    std::vector<bool> vect;
+    if (!options.reference.empty())
     {
-        std::cout << "Please give an input file" << std::endl;
-        return 0;
+        vect = read_answer_test(options.reference, matrix.size()); // read best vector solution from QPLIB
     }
-    std::string filename = argv[1];
-    std::string filename_answer = argv[2];
-    std::string solver = argv[3];
-    Matrix matrix = read_file_test(filename); // read matrix from QPLIB
 
-    std::vector<bool> vect = read_answer_test(filename_answer, matrix.size()); // read best vector solution from QPLIB
+    std::vector<std::string> filename_split = split(options.instance, '/');
 
-    std::vector<std::string> filename_split = split(filename, '/');
+    std::vector<bool> result;
+    std::vector<std::vector<bool>> warm_start;
+    for (auto const &path : options.warm_start_paths)
+    {
+        std::vector<bool> solution = read_answer_test(path, matrix.size());
+        if (!solution.empty())
+        {
+            warm_start.push_back(solution);
+        }
+    }
 
-    auto size = matrix.size();
-    std::vector<double> sum_of_positive_off_diagonal(size, 0);
-    std::vector<double> sum_of_negative_off_diagonal(size, 0);
-    std::vector<int> fixed_x(size, -1);
-    for (unsigned i = 0; i < size; i++)
+    // matrix = lower_triagular_matrix(matrix, size); // make it lower triangular
+    // tuned parameters of this instance class, the defaults otherwise
+    SolverConfiguration configuration;
+    configuration.solver = solver;
+    if (solver == "AUTO")
     {
-        for (unsigned j = 0; j < i; j++)
+        InstanceFeatures features = extract_features(SparseMatrix(matrix));
+        configuration = select_solver(features, options.rules_path.empty() ? default_selection_rules() : read_selection_rules(options.rules_path));
+        solver = configuration.solver;
+        std::cout << "AUTO selected " << solver << " for " << describe(features) << std::endl;
+    }
+    if (!options.configuration_path.empty())
+    {
+        auto configurations = read_configurations(options.configuration_path);
+        auto tuned = configurations.find(instance_class(matrix) + " " + solver);
+        if (tuned != configurations.end())
         {
-            if (matrix(i, j) > 0)
+            configuration = tuned->second;
+        }
+    }
+    for (auto const &[name, value] : options.parameters)
+    {
+        set_parameter(configuration, name, value);
+    }
+    unsigned seed = options.has_seed ? options.seed : std::random_device()();
+    // the solvers work on a renumbered copy whose interacting variables sit close together
+    std::shared_ptr<Matrix> permuted_matrix;
+    std::vector<unsigned> order;
+    if (options.reorder == "rcm")
+    {
+        SparseMatrix sparse(matrix);
+        order = reverse_cuthill_mckee(sparse);
+        permuted_matrix = std::make_shared<Matrix>(permute_matrix(matrix, order));
+        std::vector<unsigned> identity(matrix.size());
+        std::iota(identity.begin(), identity.end(), 0);
+        std::cout << "Reverse Cuthill-McKee order, bandwidth " << bandwidth(sparse, identity) << " -> " << bandwidth(sparse, order) << std::endl;
+    }
+    Matrix const &solver_matrix = permuted_matrix ? *permuted_matrix : matrix;
+    Heuristic *heuristic = create_heuristic(configuration, solver_matrix, seed);
+    if (heuristic == nullptr)
+    {
+        std::cout << "Unknown solver " << solver << "\n\n"
+                  << usage();
+        return 1;
+    }
+    std::vector<std::shared_ptr<Matrix>> replicas(replica_count);
+    if (parallel > 1)
+    {
+        if (!options.checkpoint_path.empty())
+        {
+            std::cout << "--checkpoint is not supported with --parallel" << std::endl;
+            delete heuristic;
+            return 1;
+        }
+        std::vector<std::unique_ptr<Heuristic>> searches;
+        std::vector<std::vector<unsigned>> affinity;
+        if (nodes.empty())
+        {
+            searches.emplace_back(heuristic);
+            for (unsigned k = 1; k < parallel; k++)
             {
-                sum_of_positive_off_diagonal[i] += matrix(i, j);
+                searches.emplace_back(create_heuristic(configuration, solver_matrix, seed + k));
             }
-            if (matrix(i, j) < 0)
+        }
+        else
+        {
+            // build replicas and solver state on the node of their thread, so first touch places them there
+            delete heuristic;
+            searches.resize(parallel);
+            for (unsigned k = 0; k < parallel; k++)
             {
-                sum_of_negative_off_diagonal[i] += matrix(i, j);
+                unsigned node = k % nodes.size();
+                affinity.push_back(nodes[node].cpus);
+                run_on_cpus(nodes[node].cpus, [&]()
+                            {
+                    if (node < replicas.size() && !replicas[node])
+                    {
+                        replicas[node] = std::make_shared<Matrix>(solver_matrix);
+                    }
+                    searches[k].reset(create_heuristic(configuration, node < replicas.size() ? *replicas[node] : solver_matrix, seed + k)); });
             }
+            std::cout << "NUMA nodes used: " << std::min<unsigned>(nodes.size(), parallel) << ", replicas of Q: " << replicas.size() << std::endl;
         }
+        auto parallel_search = new ParallelSearch(std::move(searches), matrix.size());
+        parallel_search->set_affinity(affinity);
+        heuristic = parallel_search;
     }
-
-    std::vector<bool> result;
-    unsigned time = 600;
-    if (argc == 5)
+    if (permuted_matrix)
     {
-        time = std::stoi(argv[4]);
+        heuristic = new PermutedHeuristic(std::unique_ptr<Heuristic>(heuristic), permuted_matrix, order);
     }
-
-    // matrix = lower_triagular_matrix(matrix, size); // make it lower triangular
-    if (solver == "DTSS")
+    if (!warm_start.empty())
     {
-        Heuristic *tabu_search = new DTSSearch{matrix, size};
-        tabu_search->solve(time);
-        result = tabu_search->get_solution();
-        std::cout << solver << " " << filename_split[filename_split.size() - 1] << std::endl;
-        std::cout << tabu_search->get_output() << std::endl;
+        heuristic->warm_start(warm_start);
     }
-    else if (solver == "MSTS")
+    if (!options.resume_path.empty())
     {
-        Heuristic *tabu_search = new MSTSearch{matrix, size};
-        tabu_search->solve(time);
-        result = tabu_search->get_solution();
-        std::cout << solver << " " << filename_split[filename_split.size() - 1] << std::endl;
-        std::cout << tabu_search->get_output() << std::endl;
+        std::ifstream checkpoint(options.resume_path, std::ios::binary);
+        if (!heuristic->load_checkpoint(checkpoint))
+        {
+            std::cout << "Checkpoint " << options.resume_path << " does not belong to " << solver << " on this instance" << std::endl;
+            return 1;
+        }
     }
-    else if (solver == "SA")
+    if (!options.checkpoint_path.empty())
     {
-        Heuristic *tabu_search = new SimAnneal{matrix, size};
-        tabu_search->solve(time);
-        result = tabu_search->get_solution();
-        std::cout << solver << " " << filename_split[filename_split.size() - 1] << std::endl;
-        std::cout << tabu_search->get_output() << std::endl;
+        install_checkpoint_signal_handlers();
+        heuristic->set_checkpoint(options.checkpoint_path, options.checkpoint_interval);
+    }
+    if (options.has_target)
+    {
+        heuristic->set_target(options.target);
+    }
+    // island model: trade incumbents with other gummy processes between outer iterations
+    std::unique_ptr<IslandLink> island_link;
+    std::unique_ptr<IslandExchange> island_exchange;
+    SparseMatrix island_matrix;
+    if (!options.island_address.empty())
+    {
+        island_link = std::make_unique<IslandLink>(options.island_address, options.island_peers);
+        if (!island_link->ok())
+        {
+            std::cout << "Island " << options.island_address << ": " << island_link->error() << std::endl;
+            delete heuristic;
+            return 1;
+        }
+        island_matrix = SparseMatrix(matrix);
+        island_exchange = std::make_unique<IslandExchange>(*island_link, island_matrix, options.island_interval);
+        heuristic->set_iteration_callback([&island_exchange, heuristic](std::vector<bool> const &best_solution, double best_value)
+                                          { island_exchange->exchange(*heuristic, best_solution, best_value); });
+    }
+    heuristic->solve(time);
+    // re-optimise the edited instance from the current search state, a rejected edit file keeps the first result
+    std::vector<QuboEdit> edits;
+    if (!options.edits_path.empty() && read_edits(options.edits_path, matrix.size(), edits))
+    {
+        heuristic->update_instance(matrix.apply(edits));
+        for (unsigned node = 0; node < replicas.size(); node++)
+        {
+            run_on_cpus(nodes[node].cpus, [&]()
+                        { *replicas[node] = solver_matrix; });
+        }
+        if (island_exchange)
+        {
+            island_matrix = SparseMatrix(matrix);
+        }
+        heuristic->solve(time);
     }
+    result = heuristic->get_solution();
+    std::cout << solver << " " << filename_split[filename_split.size() - 1] << std::endl;
+    if (options.log_path.empty())
+    {
+        std::cout << heuristic->get_output() << std::endl;
+    }
+    else
+    {
+        std::ofstream log_file(options.log_path);
+        log_file << heuristic->get_output();
+    }
+    std::string statistics = heuristic->get_statistics();
+    if (!statistics.empty())
+    {
+        std::cout << statistics << std::endl;
+    }
+    if (island_exchange)
+    {
+        std::cout << island_exchange->summary() << std::endl;
+    }
+    delete heuristic;
 
     duration_ms = std::chrono::high_resolution_clock::now() - start_time_ms;
 
+    // evaluate the found, the reference and all solutions to verify in one pass
+    SparseMatrix sparse(matrix);
+    std::vector<std::vector<bool>> solutions{result};
+    std::vector<bool> verifiable;
+    for (auto const &path : options.verify_paths)
+    {
+        solutions.push_back(read_answer_test(path, matrix.size()));
+        verifiable.push_back(!solutions.back().empty());
+        // an unreadable file keeps its place in the batch and is reported as "-"
+        solutions.back().resize(matrix.size(), false);
+    }
+    if (!vect.empty())
+    {
+        solutions.push_back(vect);
+    }
+    std::vector<double> values = evaluate_batch(sparse, solutions);
+
+    if (!options.solution_path.empty())
+    {
+        // QPLIB solution format, readable by --warm-start and --verify
+        std::ofstream solution_file(options.solution_path);
+        write_answer(solution_file, values[0], result);
+    }
+
     /*
     If we want to write the best solution vector in the output
     for (int i = 0; i < result.size(); i++)
@@ -134,10 +395,26 @@ int main(int argc, char const *argv[])
 
     std::cout << filename_split[filename_split.size() - 1] << " "
               << matrix.size() << " "
-              << read_file_nonzero(filename) << " "
-              << std::setprecision(0) << std::fixed << eval(matrix, result) << " "
-              << std::setprecision(2) << std::fixed << duration_ms.count() / 1000 << "s "
-              << std::setprecision(0) << std::fixed << eval(matrix, vect) << " "
-              << read_answer_best(filename_answer) // read best objective value from QPLIB
-              << std::endl;
+              << read_file_nonzero(options.instance) << " "
+              << std::setprecision(0) << std::fixed << values[0] << " "
+              << std::setprecision(2) << std::fixed << duration_ms.count() / 1000 << "s ";
+    if (vect.empty())
+    {
+        std::cout << "- -" << std::endl;
+    }
+    else
+    {
+        std::cout << std::setprecision(0) << std::fixed << values.back() << " "
+                  << read_answer_best(options.reference) // read best objective value from QPLIB
+                  << std::endl;
+    }
+    for (unsigned i = 0; i < options.verify_paths.size(); i++)
+    {
+        if (!verifiable[i])
+        {
+            std::cout << options.verify_paths[i] << " -" << std::endl;
+            continue;
+        }
+        std::cout << options.verify_paths[i] << " " << std::setprecision(0) << std::fixed << values[i + 1] << std::endl;
+    }
 }
@@ -1,13 +1,17 @@
 /*
     reading the matrix and solution from QPLIB
 */
+#ifndef read_file_H
+#define read_file_H
 #include "Matrix.hpp"
 #include <algorithm>
 #include <bitset>
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <numeric>
 #include <random>
 #include <sstream>
@@ -17,7 +21,7 @@
 /// @brief Count numbers of nonzero elements in square matrix
 /// @param matrix Matrix Q
 /// @return Number of nonzero elements in square matrix
-int count_nonzero_all(std::vector<std::vector<double>> matrix)
+inline int count_nonzero_all(std::vector<std::vector<double>> matrix)
 {
     double sum = 0;
     for (unsigned long i = 0; i < matrix.size(); i++)
@@ -36,7 +40,7 @@ int count_nonzero_all(std::vector<std::vector<double>> matrix)
 /// @brief Count numbers of nonzero elements in matrix diagonal
 /// @param matrix Matrix Q
 /// @return Number of nonzero elements in matrix diagonal
-int count_nonzero_diag(std::vector<std::vector<double>> matrix)
+inline int count_nonzero_diag(std::vector<std::vector<double>> matrix)
 {
     double sum = 0;
     for (unsigned long i = 0; i < matrix.size(); i++)
@@ -52,7 +56,7 @@ int count_nonzero_diag(std::vector<std::vector<double>> matrix)
 /// @brief Generate square zero matrix
 /// @param n Matrix size
 /// @return Square zero matrix
-std::vector<std::vector<double>> create_zero_matrix(unsigned n)
+inline std::vector<std::vector<double>> create_zero_matrix(unsigned n)
 {
     std::normal_distribution<double> generator{0, 1};
     std::vector<std::vector<double>> result;
@@ -67,7 +71,7 @@ std::vector<std::vector<double>> create_zero_matrix(unsigned n)
 /// @brief Read file from Prof. Koch instances
 /// @param filepath Path of file
 /// @return Matrix
-std::vector<std::vector<double>> read_file(std::string filepath)
+inline std::vector<std::vector<double>> read_file(std::string filepath)
 {
     std::ifstream input_file(filepath);
 
@@ -86,22 +90,56 @@ std::vector<std::vector<double>> read_file(std::string filepath)
     return matrix; // Exploit Copy Elision
 }
 
-/// @brief Read file from QPLIB instances
+/// @brief Read the problem size and the number of quadratic terms of a QPLIB instance without loading it
 /// @param filepath Path of file
-/// @return Matrix
-Matrix read_file_test(std::string filepath)
+/// @param row_count Receives the problem size
+/// @param nonlinear_count Receives the number of quadratic terms
+/// @return False if the header could not be read
+inline bool read_file_header(std::string filepath, unsigned &row_count, unsigned &nonlinear_count)
 {
-    Matrix matrix;
-
     std::ifstream input_file(filepath);
+    std::string line;
+    for (int iteration = 1; iteration <= 5 && getline(input_file, line); iteration++)
+    {
+        std::stringstream ss;
+        ss.str(line);
+        if (iteration == 4 && !(ss >> row_count))
+        {
+            return false;
+        }
+        if (iteration == 5)
+        {
+            return bool(ss >> nonlinear_count);
+        }
+    }
+    return false;
+}
+
+/// @brief Decides before the matrix is allocated if an instance of n variables and some quadratic terms is read,
+///        and may change the storage
+using InstanceCheck = std::function<bool(unsigned n, unsigned terms, Matrix::Storage &storage)>;
+
+/// @brief Read a QPLIB instance from a stream, stops after the linear coefficients of the objective
+/// @param input_file Stream positioned at the start of the instance
+/// @param storage How the matrix holds the coefficients
+/// @param check Optional check of the header, a refused instance is not read
+/// @return Matrix, of size 0 if the stream holds no instance, the check refused it, a line does not parse,
+///         an index is outside 1..n or the stream ends before the terms the header announced
+inline Matrix read_instance(std::istream &input_file, Matrix::Storage storage = Matrix::Storage::dense_double, InstanceCheck const &check = nullptr)
+{
+    Matrix matrix;
 
     int iteration = 0;
-    int row_count;
-    int nonlinear_count;
+    long long row_count = 0;
+    long long nonlinear_count = 0;
     double nonlinear_value;
-    int linear_count;
+    long long linear_count = 0;
     std::string line;
-    std::string str;
+    // an index is valid in 1..n
+    auto index = [&row_count](long long value)
+    {
+        return value >= 1 && value <= row_count;
+    };
 
     while (getline(input_file, line))
     {
@@ -110,71 +148,94 @@ Matrix read_file_test(std::string filepath)
         {
             continue;
         }
+        std::stringstream ss;
+        ss.str(line);
+        bool valid = true;
         if (iteration == 4)
         {
-            std::stringstream ss;
-            ss.str(line);
-            ss >> row_count;
-            matrix = Matrix(row_count);
+            valid = (ss >> row_count) && row_count >= 1 && row_count <= std::numeric_limits<int>::max();
         }
         if (iteration == 5)
         {
-            std::stringstream ss;
-            ss.str(line);
-            ss >> nonlinear_count;
+            valid = (ss >> nonlinear_count) && nonlinear_count >= 0 && nonlinear_count <= std::numeric_limits<int>::max() - 8;
+            if (valid && check && !check(row_count, nonlinear_count, storage))
+            {
+                return Matrix();
+            }
+            if (valid)
+            {
+                matrix = Matrix(row_count, storage);
+            }
         }
         if (iteration > 5 and iteration <= 5 + nonlinear_count)
         {
-            std::stringstream ss;
-            int row;
-            int column;
+            long long row;
+            long long column;
             double value;
-            ss.str(line);
-            ss >> row >> column >> value;
-            matrix(row - 1, column - 1) = value / 2;
-            if (row - 1 < column - 1)
+            valid = (ss >> row >> column >> value) && index(row) && index(column);
+            if (valid)
             {
-                std::cout << "Ouch" << std::endl;
+                matrix.set(row - 1, column - 1, value / 2);
+                if (row - 1 < column - 1)
+                {
+                    std::cout << "Ouch" << std::endl;
+                }
             }
         }
         if (iteration == 5 + nonlinear_count + 1)
         {
-            std::stringstream ss;
-            ss.str(line);
-            ss >> nonlinear_value;
-            for (int i = 0; i < row_count; ++i)
+            valid = bool(ss >> nonlinear_value);
+            for (int i = 0; valid && i < row_count; ++i)
             {
-                matrix(i, i) = nonlinear_value;
+                matrix.set(i, i, nonlinear_value);
             }
         }
         if (iteration == 5 + nonlinear_count + 2)
         {
-            std::stringstream ss;
-            ss.str(line);
-            ss >> linear_count;
+            valid = (ss >> linear_count) && linear_count >= 0 && linear_count <= row_count;
         }
 
         if (iteration > 5 + nonlinear_count + 2 and iteration <= 5 + nonlinear_count + 2 + linear_count)
         {
-            std::stringstream ss;
-            int row;
+            long long row;
             double value;
-            ss.str(line);
-            ss >> row >> value;
-            matrix(row - 1, row - 1) = value;
+            valid = (ss >> row >> value) && index(row);
+            if (valid)
+            {
+                matrix.set(row - 1, row - 1, value);
+            }
+        }
+        if (!valid)
+        {
+            return Matrix();
+        }
+        // the remaining sections do not concern the objective, a socket may not even send them
+        if (iteration == 5 + nonlinear_count + 2 + linear_count)
+        {
+            return matrix;
         }
     }
+    // the stream ended inside the objective
+    return Matrix();
+}
 
-    return matrix;
+/// @brief Read file from QPLIB instances
+/// @param filepath Path of file
+/// @param storage How the matrix holds the coefficients
+/// @param check Optional check of the header, see read_instance
+/// @return Matrix, of size 0 if the file is not a valid instance
+inline Matrix read_file_test(std::string filepath, Matrix::Storage storage = Matrix::Storage::dense_double, InstanceCheck const &check = nullptr)
+{
+    std::ifstream input_file(filepath);
+    return read_instance(input_file, storage, check);
 }
 
 /// @brief Calculate number of nonzero elements in qs file
 /// @param filepath File path
 /// @return Number of nonzero elements (in double..???)
-double read_file_nonzero(std::string filepath)
+inline double read_file_nonzero(std::string filepath)
 {
     double nonzero = 0;
-    std::vector<std::vector<double>> matrix;
 
     std::ifstream input_file(filepath);
 
@@ -197,7 +258,6 @@ double read_file_nonzero(std::string filepath)
             std::stringstream ss;
             ss.str(line);
             ss >> row_count;
-            matrix = create_zero_matrix(row_count);
         }
         if (iteration == 5)
         {
@@ -224,16 +284,21 @@ double read_file_nonzero(std::string filepath)
         }
     }
 
-    return nonzero / (row_count * row_count);
+    return nonzero / (double(row_count) * row_count);
 }
 
 /// @brief Read objective vector for .qs files
 /// @param filepath filepath
 /// @param size size of problem
-/// @return Solution vector
-std::vector<bool> read_answer_test(std::string filepath, int size)
+/// @return Solution vector, empty (with a message) if the file cannot be read or does not fit the problem
+inline std::vector<bool> read_answer_test(std::string filepath, int size)
 {
     std::ifstream input_file(filepath);
+    if (!input_file)
+    {
+        std::cout << "Cannot read solution " << filepath << std::endl;
+        return {};
+    }
     std::vector<bool> vect(size, false);
     std::string line;
     int iteration = 0;
@@ -241,35 +306,100 @@ std::vector<bool> read_answer_test(std::string filepath, int size)
     while (getline(input_file, line))
     {
         iteration++;
-        if (iteration < 2)
+        if (iteration < 2 || line.find_first_not_of(" \t\r") == std::string::npos)
         {
             continue;
         }
-        else
+        // "b{index + 2} {value}", the letter is the variable type
+        std::stringstream ss(line);
+        std::string loc;
+        double value;
+        unsigned long index = 0;
+        bool valid = bool(ss >> loc >> value) && loc.size() > 1 &&
+                     loc.find_first_not_of("0123456789", 1) == std::string::npos && loc.size() < 12;
+        if (valid)
         {
-            std::stringstream ss;
-            std::string loc;
-            std::string loc_1;
-            double value;
-            ss.str(line);
-            ss >> loc >> value;
-            for (unsigned long j = 0; j < loc.size(); j++)
-            {
-                if (j != 0)
-                {
-                    loc_1 = loc_1 + loc[j];
-                }
-            }
-            vect[stoi(loc_1) - 2] = true;
+            index = std::stoul(loc.substr(1));
+            valid = index >= 2 && index - 2 < vect.size();
+        }
+        if (!valid)
+        {
+            std::cout << filepath << ":" << iteration << ": \"" << line << "\" is not a variable of this instance" << std::endl;
+            return {};
         }
+        vect[index - 2] = value > 0.5;
     }
     return vect;
 }
 
+/// @brief Write a solution in the QPLIB solution format read by read_answer_test and read_answer_best
+/// @param output_file Output stream
+/// @param value Objective value
+/// @param solution Solution vector
+inline void write_answer(std::ostream &output_file, double value, std::vector<bool> const &solution)
+{
+    output_file << "objvar " << std::setprecision(15) << value << "\n";
+    for (unsigned i = 0; i < solution.size(); i++)
+    {
+        if (solution[i])
+        {
+            output_file << "b" << i + 2 << " 1\n";
+        }
+    }
+}
+
+/// @brief Read coefficient edits, one "row column value" line per term in .qs numbering and scale,
+///        row == column edits the linear coefficient
+/// @param filepath File path
+/// @param size Size of the problem
+/// @param edits Receives the edits with the new coefficients (0 removes a term)
+/// @return False (with a message) if the file cannot be read, a line does not parse or an index is outside 1..size,
+///         no edit is kept then
+inline bool read_edits(std::string filepath, unsigned size, std::vector<QuboEdit> &edits)
+{
+    edits.clear();
+    std::ifstream input_file(filepath);
+    if (!input_file)
+    {
+        std::cout << "Cannot read edits " << filepath << std::endl;
+        return false;
+    }
+    std::string line;
+    int iteration = 0;
+    while (getline(input_file, line))
+    {
+        iteration++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        std::stringstream ss(line);
+        long long row;
+        long long column;
+        double value;
+        std::string rest;
+        bool valid = bool(ss >> row >> column >> value) && !(ss >> rest) &&
+                     row >= 1 && row <= size && column >= 1 && column <= size;
+        if (!valid)
+        {
+            std::cout << filepath << ":" << iteration << ": \"" << line << "\" is not a term of this instance" << std::endl;
+            edits.clear();
+            return false;
+        }
+        // off-diagonal terms are halved like in read_file_test
+        if (row != column)
+        {
+            value = value / 2;
+        }
+        edits.push_back(QuboEdit{unsigned(row - 1), unsigned(column - 1), value});
+    }
+    return true;
+}
+
 /// @brief Read objective vector for .qs files
 /// @param filepath filepath
 /// @return Solution vector
-double read_answer_best(std::string filepath)
+inline double read_answer_best(std::string filepath)
 {
     std::ifstream input_file(filepath);
     std::string obj;
@@ -278,3 +408,4 @@ double read_answer_best(std::string filepath)
 
     return ans; // Exploit Copy Elision
 }
+#endif